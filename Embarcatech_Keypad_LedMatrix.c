@@ -4,17 +4,25 @@
 #include "hardware/pwm.h"
 #include "hardware/clocks.h"
 #include "hardware/pio.h"           // Biblioteca para manipulação de periféricos PIO
-#include "ws2818b.pio.h"             // Programa para controle de LEDs WS2812B
 #include "pico/bootrom.h" 
+#include "neopixel.h"                // Controle da matriz de LEDs WS2812B
+#include "buzzer.h"                  // Controle do buzzer via PWM
+#include "anim_vm.h"                 // Máquina virtual de animações
+#include "anim_store.h"              // Animações gravadas na flash
+#include "telemetry.h"               // Uso de RAM e pilha
+#include "compositor.h"              // Composição de camadas
+#include "font.h"                    // Texto com rolagem
+#include "hdr.h"                     // Framebuffer de 16 bits com dithering
+#include "color.h"                   // Matemática de cores empacotadas
+#include "palette.h"                 // Framebuffer indexado com paleta
+#include "pattern.h"                 // Padrões geométricos em máscaras de bits
          
 
 #define ROWS 4
 #define COLS 4
 
-#define LED_COUNT 25                // Número de LEDs na matriz
-#define LED_PIN 7                   // Pino GPIO conectado aos LEDs
-
 const uint buzzer_pin = 10; // GPIO do buzzer
+char scroll_text[64] = "EMBARCATECH"; // Texto mostrado pela tecla 8 (alterado pelo comando T)
 const uint row_pins[4] = {28, 27, 26, 22}; 
 const uint col_pins[4] = {21, 20, 19, 18};
 
@@ -26,116 +34,17 @@ const char keys[ROWS][COLS] = {
     {'*', '0', '#', 'D'}
 };
 
-// Estrutura para representar um pixel com componentes RGB
-struct pixel_t { 
-    uint32_t G, R, B;                // Componentes de cor: Verde, Vermelho e Azul
-};
-
-
-typedef struct pixel_t pixel_t;     // Alias para a estrutura pixel_t
-typedef pixel_t npLED_t;            // Alias para facilitar o uso no contexto de LEDs
-
-npLED_t leds[LED_COUNT];            // Array para armazenar o estado de cada LED
-PIO np_pio;                         // Variável para referenciar a instância PIO usada
-uint sm;                            // Variável para armazenar o número do state machine usado
-
-int getIndex(int x, int y) {
-    // Se a linha for par (0, 2, 4), percorremos da esquerda para a direita.
-    // Se a linha for ímpar (1, 3), percorremos da direita para a esquerda.
-    if (y % 2 == 0) {
-        return 24-(y * 5 + x); // Linha par (esquerda para direita).
-    } else {
-        return 24-(y * 5 + (4 - x)); // Linha ímpar (direita para esquerda).
-    }
-}
-
-// Função para inicializar o PIO para controle dos LEDs
-void npInit(uint pin) 
-{
-    uint offset = pio_add_program(pio0, &ws2818b_program); // Carregar o programa PIO
-    np_pio = pio0;                                         // Usar o primeiro bloco PIO
-
-    sm = pio_claim_unused_sm(np_pio, false);              // Tentar usar uma state machine do pio0
-    if (sm < 0)                                           // Se não houver disponível no pio0
-    {
-        np_pio = pio1;                                    // Mudar para o pio1
-        sm = pio_claim_unused_sm(np_pio, true);           // Usar uma state machine do pio1
-    }
-
-    ws2818b_program_init(np_pio, sm, offset, pin, 800000.f); // Inicializar state machine para LEDs
-
-    for (uint i = 0; i < LED_COUNT; ++i)                  // Inicializar todos os LEDs como apagados
-    {
-        leds[i].R = 0;
-        leds[i].G = 0;
-        leds[i].B = 0;
-    }
-}
-
-// Função para definir a cor de um LED específico
-void npSetLED(const uint index, const uint8_t r, const uint8_t g, const uint8_t b) 
-{
-    leds[index].R = r;                                    // Definir componente vermelho
-    leds[index].G = g;                                    // Definir componente verde
-    leds[index].B = b;                                    // Definir componente azul
-}
-
-// Função para limpar (apagar) todos os LEDs
-void npClear() 
-{
-    for (uint i = 0; i < LED_COUNT; ++i)                  // Iterar sobre todos os LEDs
-        npSetLED(i, 0, 0, 0);                             // Definir cor como preta (apagado)
-}
-
-// Função para atualizar os LEDs no hardware
-void npWrite() 
-{
-    for (uint i = 0; i < LED_COUNT; ++i)                  // Iterar sobre todos os LEDs
-    {
-        pio_sm_put_blocking(np_pio, sm, leds[i].G<<24);       // Enviar componente verde
-        pio_sm_put_blocking(np_pio, sm, leds[i].R<<24);       // Enviar componente vermelho
-        pio_sm_put_blocking(np_pio, sm, leds[i].B<<24);       // Enviar componente azul
-    }
-}
-
-//função para inicializar o buzzer
-void pico_buzzer_init(uint gpio) {
-    gpio_set_function(gpio, GPIO_FUNC_PWM);
-    uint slice_num = pwm_gpio_to_slice_num(gpio);
-    pwm_set_enabled(slice_num, true);
-}
-
-//função para tocar uma nota no buzzer
-void pico_buzzer_play(uint gpio, uint frequency) {
-    uint slice_num = pwm_gpio_to_slice_num(gpio);
-    uint32_t clock = 125000000; 
-    uint32_t divider = clock / (frequency * 4096); 
-    uint32_t wrap = (clock / divider) / frequency - 1;
-    uint32_t level = wrap / 2; 
-    pwm_set_clkdiv(slice_num, divider);
-    pwm_set_wrap(slice_num, wrap);
-    pwm_set_chan_level(slice_num, PWM_CHAN_A, level);
-    pwm_set_enabled(slice_num, true);
-}
-
-//função para parar o buzzer
-void pico_buzzer_stop(uint gpio) {
-    uint slice_num = pwm_gpio_to_slice_num(gpio);
-    pwm_set_chan_level(slice_num, PWM_CHAN_A, 0);
-    pwm_set_enabled(slice_num, false);
-}
-
 //função para tocar uma melodia
 void play_musica(uint gpio) {
-    int melody[] = {294,330,349,440,392,440,262,294,330,349,330,392,440,392,349,349,349,349,440,440,392,349,
+    static const int melody[] = {294,330,349,440,392,440,262,294,330,349,330,392,440,392,349,349,349,349,440,440,392,349,
     440,440,440,392,440,392,349,349,349,349,440,440,392,349,440,440,440,554,554,554,349,349,349,440,440,392,349,
     466,466,466,392,523,440,659,698,587,698,880,659,554,880,1109,1175};
 
-    int noteDurations[] = {600,300,600,300,300,300,600,600,300,300,300,300,300,300,300,150,150,150,150,150,150,300,
+    static const int noteDurations[] = {600,300,600,300,300,300,600,600,300,300,300,300,300,300,300,150,150,150,150,150,150,300,
     150,150,150,150,150,150,300,150,150,150,150,150,150,300,150,150,300,150,150,300,150,150,150,150,150,150,300,
     150,150,150,300,300,300,300, 75, 75, 75, 75, 75, 75, 75, 75,1200};
     
-    int pausa[ ] = {300, 0 ,600,150,150, 0, 600,300, 0, 300,300,300,300,300,600,150,150,150,150,150,150,300,150, 
+    static const int pausa[ ] = {300, 0 ,600,150,150, 0, 600,300, 0, 300,300,300,300,300,600,150,150,150,150,150,150,300,150, 
     150,150,150,150,150,300,150,150,150,150,150,150,300,150,150,300,150,150,300,150,150,150,150,150,150,300,150,
     150,150,300,300,300,300, 75, 75, 75, 75, 75, 75, 75,  75, 1200 }; 
     
@@ -146,10 +55,8 @@ void play_musica(uint gpio) {
         int halfDuration = noteDuration / 2;
         int amplitude = (frequency % 5) + 1; // Altura da oscilação baseada na frequência
 
-        // Mapeia a frequência para uma cor
-        int red = 255 - (frequency % 256);
-        int blue = frequency % 256;
-        int green = 0; // se quiser dar uma variada na cor, basta alterar o valor de green
+        // Mapeia a frequência para um matiz entre o vermelho (0) e o azul (171), passando pelo magenta
+        uint32_t color = color_hsv((256 - (frequency % 256) * 85 / 255) & 0xFF, 255, 255);
 
         pico_buzzer_play(gpio, frequency);
 
@@ -159,7 +66,7 @@ void play_musica(uint gpio) {
                     int offset = (t < halfDuration) ? (t * amplitude / halfDuration) : ((noteDuration - t) * amplitude / halfDuration);
                     if (x == 2) { // Coluna central
                         if (y == 2 - offset || y == 2 + offset) {
-                            npSetLED(y * 5 + x, red, green, blue); // Acende o LED com a cor calculada
+                            npSetLED(y * 5 + x, color >> 16, color >> 8, color); // Acende o LED com a cor calculada
                         } else {
                             npSetLED(y * 5 + x, 0, 0, 0); // Apaga o LED
                         }
@@ -168,7 +75,7 @@ void play_musica(uint gpio) {
                         if (t >= delay) {
                             int localOffset = ((t - delay) < halfDuration) ? ((t - delay) * amplitude / halfDuration) : ((noteDuration - (t - delay)) * amplitude / halfDuration);
                             if (y == 2 - localOffset || y == 2 + localOffset) {
-                                npSetLED(y * 5 + x, red, green, blue); // Acende o LED com a cor calculada
+                                npSetLED(y * 5 + x, color >> 16, color >> 8, color); // Acende o LED com a cor calculada
                             } else {
                                 npSetLED(y * 5 + x, 0, 0, 0); 
                             }
@@ -180,7 +87,7 @@ void play_musica(uint gpio) {
                         if (t >= delay) {
                             int localOffset = ((t - delay) < halfDuration) ? ((t - delay) * amplitude / halfDuration) : ((noteDuration - (t - delay)) * amplitude / halfDuration);
                             if (y == 2 - localOffset || y == 2 + localOffset) {
-                                npSetLED(y * 5 + x, red, green, blue); // Acende o LED com a cor calculada
+                                npSetLED(y * 5 + x, color >> 16, color >> 8, color); // Acende o LED com a cor calculada
                             } else {
                                 npSetLED(y * 5 + x, 0, 0, 0); // Apaga o LED
                             }
@@ -238,7 +145,19 @@ char pico_scan_keypad() {
     return '\0'; // Retorna null se nenhum botão for pressionado
 }
 
-void print_frame(int frame[5][5][3], int sleep_time)
+// Verifica, sem bloquear, se alguma tecla está pressionada
+bool pico_keypad_pressed() {
+    bool pressed = false;
+    for (int r = 0; r < ROWS; r++)
+        gpio_put(row_pins[r], 0); // Ativa todas as linhas
+    for (int c = 0; c < COLS; c++)
+        pressed |= !gpio_get(col_pins[c]);
+    for (int r = 0; r < ROWS; r++)
+        gpio_put(row_pins[r], 1); // Desativa todas as linhas
+    return pressed;
+}
+
+void print_frame(const int frame[5][5][3], int sleep_time)
 {
     for(int linha = 0; linha < 5; linha++){
         for(int coluna = 0; coluna < 5; coluna++){
@@ -251,10 +170,14 @@ void print_frame(int frame[5][5][3], int sleep_time)
     npClear();
 }
 
-//Acende toda a matriz controlando o brilho
-void setBrightness(uint8_t r, uint8_t g, uint8_t b, float brightness_red, float brightness_green, float brightness_blue) {
+//Acende toda a matriz com a cor 0x00RRGGBB com percent% de brilho
+void setBrightness(uint32_t color, uint percent) {
+    // Divisão exata por canal, feita uma vez: 255 a 20% dá 51, o mesmo nível em que termina o fade da tecla #
+    uint8_t r = ((color >> 16) & 0xFF) * percent / 100;
+    uint8_t g = ((color >> 8) & 0xFF) * percent / 100;
+    uint8_t b = (color & 0xFF) * percent / 100;
     for (int i = 0; i < LED_COUNT; i++) {
-        npSetLED(i, r * brightness_red, g * brightness_green, b * brightness_blue);
+        npSetLED(i, r, g, b);
     }
     npWrite();
 }
@@ -280,118 +203,43 @@ void animacao1(){
 }
 
 void animacao2(){
-    int matriz[5][5][3] = {
-                {{0, 101, 4}, {0, 101, 4}, {0, 101, 4}, {0, 101, 4}, {0, 101, 4}},
-                {{0, 101, 4}, {0, 0, 0}, {0, 101, 4}, {0, 0, 0}, {0, 101, 4}},
-                {{0, 101, 4}, {0, 101, 4}, {0, 0, 0}, {0, 101, 4}, {0, 101, 4}},
-                {{0, 101, 4}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 101, 4}},
-                {{0, 101, 4}, {0, 0, 0}, {0, 101, 4}, {0, 0, 0}, {0, 101, 4}}
-                };
-    // Desenhando Sprite contido na matriz.c
-    for(int linha = 0; linha < 5; linha++){
-        for(int coluna = 0; coluna < 5; coluna++){
-            int posicao = getIndex(linha, coluna);
-            npSetLED(posicao, matriz[coluna][linha][0], matriz[coluna][linha][1], matriz[coluna][linha][2]);
-        }
-    }
-    npWrite();
+    // Frames em 4 bits por LED: só os índices ficam na imagem e as cores vêm da paleta
+    static const uint8_t logo[5][5] = {
+        {1, 1, 1, 1, 1},
+        {1, 0, 1, 0, 1},
+        {1, 1, 0, 1, 1},
+        {1, 0, 0, 0, 1},
+        {1, 0, 1, 0, 1}
+    };
+    // Borda, anel interno e centro; a explosão é feita trocando só as cores
+    static const uint8_t aneis[5][5] = {
+        {1, 1, 1, 1, 1},
+        {1, 2, 2, 2, 1},
+        {1, 2, 3, 2, 1},
+        {1, 2, 2, 2, 1},
+        {1, 1, 1, 1, 1}
+    };
+    static const uint32_t explosao[][3] = {
+        {0x000000, 0x000000, 0xFF0000},
+        {0x000000, 0xFF0000, 0xFFFF00},
+        {0xFF0000, 0xFFFF00, 0xFF0000},
+        {0xFFFF00, 0xFF0000, 0x000000},
+        {0xFF0000, 0x000000, 0x000000},
+        {0x000000, 0x000000, 0x000000}
+    };
+
+    pal_set_color(0, 0x000000);
+    pal_set_color(1, 0x006504);
+    pal_blit(&logo[0][0]);
+    pal_present();
     sleep_ms(500);
-    npClear();
-    int matriz2[5][5][3] = {
-        {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-        {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-        {{0, 0, 0}, {0, 0, 0}, {255, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-        {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-        {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}}
-        };
-    for(int linha = 0; linha < 5; linha++){
-        for(int coluna = 0; coluna < 5; coluna++){
-            int posicao = getIndex(linha, coluna);
-            npSetLED(posicao, matriz2[coluna][linha][0], matriz2[coluna][linha][1], matriz2[coluna][linha][2]);
-        }
-    }
-    npWrite();
-    sleep_ms(250);
-    npClear();
-    int matriz3[5][5][3] = {
-        {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-        {{0, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {0, 0, 0}},
-        {{0, 0, 0}, {255, 0, 0}, {255, 255, 0}, {255, 0, 0}, {0, 0, 0}},
-        {{0, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {0, 0, 0}},
-        {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}}
-        };
-    for(int linha = 0; linha < 5; linha++){
-        for(int coluna = 0; coluna < 5; coluna++){
-            int posicao = getIndex(linha, coluna);
-            npSetLED(posicao, matriz3[coluna][linha][0], matriz3[coluna][linha][1], matriz3[coluna][linha][2]);
-        }
-    }
-    npWrite();
-    sleep_ms(250);
-    npClear();
-    int matriz4[5][5][3] = {
-        {{255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}},
-        {{255, 0, 0}, {255, 255, 0}, {255, 255, 0}, {255, 255, 0}, {255, 0, 0}},
-        {{255, 0, 0}, {255, 255, 0}, {255, 0, 0}, {255, 255, 0}, {255, 0, 0}},
-        {{255, 0, 0}, {255, 255, 0}, {255, 255, 0}, {255, 255, 0}, {255, 0, 0}},
-        {{255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}}
-        };
-    for(int linha = 0; linha < 5; linha++){
-        for(int coluna = 0; coluna < 5; coluna++){
-            int posicao = getIndex(linha, coluna);
-            npSetLED(posicao, matriz4[coluna][linha][0], matriz4[coluna][linha][1], matriz4[coluna][linha][2]);
-        }
-    }
-    npWrite();
-    sleep_ms(250);
-    npClear();
-    int matriz5[5][5][3] = {
-        {{255, 255, 0}, {255, 255, 0}, {255, 255, 0}, {255, 255, 0}, {255, 255, 0}},
-        {{255, 255, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 255, 0}},
-        {{255, 255, 0}, {255, 0, 0}, {0,0,0}, {255, 0, 0}, {255, 255, 0}},
-        {{255, 255, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 255, 0}},
-        {{255, 255, 0}, {255, 255, 0}, {255, 255, 0}, {255, 255, 0}, {255, 255, 0}}
-        };
-    for(int linha = 0; linha < 5; linha++){
-        for(int coluna = 0; coluna < 5; coluna++){
-            int posicao = getIndex(linha, coluna);
-            npSetLED(posicao, matriz5[coluna][linha][0], matriz5[coluna][linha][1], matriz5[coluna][linha][2]);
-        }
-    }
-    npWrite();
-    sleep_ms(250);
-    npClear();
-    int matriz6[5][5][3] = {
-        {{255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}},
-        {{255, 0, 0}, {0,0,0}, {0,0,0}, {0,0,0}, {255, 0, 0}},
-        {{255, 0, 0}, {0,0,0}, {0,0,0}, {0,0,0}, {255, 0, 0}},
-        {{255, 0, 0}, {0,0,0}, {0,0,0}, {0,0,0}, {255, 0, 0}},
-        {{255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}}
-        };
-    for(int linha = 0; linha < 5; linha++){
-        for(int coluna = 0; coluna < 5; coluna++){
-            int posicao = getIndex(linha, coluna);
-            npSetLED(posicao, matriz6[coluna][linha][0], matriz6[coluna][linha][1], matriz6[coluna][linha][2]);
-        }
-    }
-    npWrite();
-    sleep_ms(250);
-    npClear();
-    int matriz7[5][5][3] = {
-        {{0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}},
-        {{0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}},
-        {{0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}},
-        {{0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}},
-        {{0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}}
-        };
-    for(int linha = 0; linha < 5; linha++){
-        for(int coluna = 0; coluna < 5; coluna++){
-            int posicao = getIndex(linha, coluna);
-            npSetLED(posicao, matriz7[coluna][linha][0], matriz7[coluna][linha][1], matriz7[coluna][linha][2]);
-        }
+
+    pal_blit(&aneis[0][0]);
+    for (uint i = 0; i < sizeof(explosao) / sizeof(explosao[0]); i++) {
+        pal_load_colors(1, explosao[i], 3);
+        pal_present();
+        sleep_ms(250);
     }
-    npWrite();
-    sleep_ms(250);
     npClear();
 }
 
@@ -401,7 +249,7 @@ void animacao3(){
     int sleep3 = 500;
 
     //inicio do X
-    int frame1[5][5][3] = {
+    static const int frame1[5][5][3] = {
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 255}, {0, 0, 0}, {0, 0, 0}},
@@ -409,7 +257,7 @@ void animacao3(){
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},}
                 };
 
-    int frame2[5][5][3] = {
+    static const int frame2[5][5][3] = {
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 0, 155}, {0, 0, 0}, {0, 0, 155}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 255}, {0, 0, 0}, {0, 0, 0}},
@@ -417,7 +265,7 @@ void animacao3(){
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},}
                 };
 
-    int frame3[5][5][3] = {
+    static const int frame3[5][5][3] = {
                 {{0, 0, 155}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 155},},
                 {{0, 0, 0}, {0, 0, 255}, {0, 0, 0}, {0, 0, 255}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 255}, {0, 0, 0}, {0, 0, 0}},
@@ -426,7 +274,7 @@ void animacao3(){
                 };
     
 
-     int frame4[5][5][3] = {
+     static const int frame4[5][5][3] = {
                 {{0, 0, 255}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 255},},
                 {{0, 0, 0}, {0, 0, 255}, {0, 0, 0}, {0, 0, 255}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 255}, {0, 0, 0}, {0, 0, 0}},
@@ -435,7 +283,7 @@ void animacao3(){
                 };
 
     //inicio do retangulo
-    int frame5[5][5][3] = {
+    static const int frame5[5][5][3] = {
                 {{0, 0, 255}, {0, 0, 255}, {0, 0, 0}, {0, 0, 255}, {0, 0, 255},},
                 {{0, 0, 255}, {0, 0, 155}, {0, 0, 0}, {0, 0, 155}, {0, 0, 255},},
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 255}, {0, 0, 0}, {0, 0, 0}},
@@ -444,7 +292,7 @@ void animacao3(){
                 };
 
     //inicio da transição de cor do retangulo
-     int frame6[5][5][3] = {
+     static const int frame6[5][5][3] = {
                 {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255},},
                 {{0, 0, 255}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 255},},
                 {{0, 0, 255}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 255}},
@@ -452,7 +300,7 @@ void animacao3(){
                 {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255},}
                 };
     
-    int frame7[5][5][3] = {
+    static const int frame7[5][5][3] = {
                 {{255, 0, 127}, {120, 0, 60}, {0, 0, 155}, {120, 0, 60}, {255, 0, 127},},
                 {{120, 0, 60}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {120, 0, 60},},
                 {{0, 0, 155}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 155}},
@@ -460,7 +308,7 @@ void animacao3(){
                 {{255, 0, 127}, {120, 0, 60}, {0, 0, 155}, {120, 0, 60}, {255, 0, 127},}
                 };
 
-     int frame8[5][5][3] = {
+     static const int frame8[5][5][3] = {
                 {{255, 0, 127}, {255, 0, 127}, {120, 0, 60}, {255, 0, 127}, {255, 0, 127},},
                 {{255, 0, 127}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {255, 0, 127},},
                 {{120, 0, 60}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {120, 0, 60},},
@@ -468,7 +316,7 @@ void animacao3(){
                 {{255, 0, 127}, {255, 0, 127}, {120, 0, 60}, {255, 0, 127}, {255, 0, 127},}
                 };
 
-    int frame9[5][5][3] = {
+    static const int frame9[5][5][3] = {
                 {{255, 0, 127}, {255, 0, 127}, {255, 0, 127}, {255, 0, 127}, {255, 0, 127},},
                 {{255, 0, 127}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {255, 0, 127},},
                 {{255, 0, 127}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {255, 0, 127}},
@@ -477,7 +325,7 @@ void animacao3(){
                 };
 
     //inicio do triangulo
-    int frame10[5][5][3] = {
+    static const int frame10[5][5][3] = {
                 {{120, 0, 60}, {120, 0, 60}, {120, 0, 60}, {120, 0, 60}, {120, 0, 60},},
                 {{120, 0, 60}, {120, 0, 60}, {255, 0, 127}, {120, 0, 60}, {120, 0, 60},},
                 {{120, 0, 60}, {255, 0, 127}, {0, 0, 0}, {255, 0, 127}, {120, 0, 60}},
@@ -485,7 +333,7 @@ void animacao3(){
                 {{120, 0, 60}, {120, 0, 60}, {120, 0, 60}, {120, 0, 60}, {120, 0, 60},}
                 };
 
-    int frame11[5][5][3] = {
+    static const int frame11[5][5][3] = {
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 0, 0}, {255, 0, 127}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {255, 0, 127}, {0, 0, 0}, {255, 0, 127}, {0, 0, 0}},
@@ -494,7 +342,7 @@ void animacao3(){
                 };
 
     //inicio da transição de cor do triangulo
-    int frame12[5][5][3] = {
+    static const int frame12[5][5][3] = {
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 0, 0}, {255, 0, 127}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 155, 0}, {0, 0, 0}, {0, 155, 0}, {0, 0, 0}},
@@ -503,7 +351,7 @@ void animacao3(){
                 };
 
     
-    int frame13[5][5][3] = {
+    static const int frame13[5][5][3] = {
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 0, 0}, {0, 155, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0}},
@@ -512,7 +360,7 @@ void animacao3(){
                 };
     
 
-    int frame14[5][5][3] = {
+    static const int frame14[5][5][3] = {
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0}},
@@ -521,7 +369,7 @@ void animacao3(){
                 };
     
     //inicio do "circulo"
-    int frame15[5][5][3] = {
+    static const int frame15[5][5][3] = {
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 255, 0}, {0, 255, 0}, {0, 255, 0}, {0, 0, 0},},
                 {{0, 255, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 255, 0}},
@@ -530,7 +378,7 @@ void animacao3(){
                 };
 
     //transição de cor
-    int frame16[5][5][3] = {
+    static const int frame16[5][5][3] = {
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {155, 0, 0}, {255, 0, 0}, {0, 255, 0}, {0, 0, 0},},
                 {{155, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {155, 0, 0}},
@@ -538,7 +386,7 @@ void animacao3(){
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},}
                 };
 
-    int frame17[5][5][3] = {
+    static const int frame17[5][5][3] = {
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {0, 0, 0},},
                 {{255, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {255, 0, 0}},
@@ -546,7 +394,7 @@ void animacao3(){
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},}
                 };
     
-    int frame18[5][5][3] = {
+    static const int frame18[5][5][3] = {
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {255, 0, 0}, {255, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{255, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {255, 0, 0}},
@@ -554,7 +402,7 @@ void animacao3(){
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},}
                 };
 
-    int frame19[5][5][3] = {
+    static const int frame19[5][5][3] = {
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {255, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{255, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {255, 0, 0}},
@@ -562,7 +410,7 @@ void animacao3(){
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},}
                 };
             
-    int frame20[5][5][3] = {
+    static const int frame20[5][5][3] = {
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{255, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {255, 0, 0}},
@@ -570,7 +418,7 @@ void animacao3(){
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},}
                 };
 
-    int frame21[5][5][3] = {
+    static const int frame21[5][5][3] = {
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
                 {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
@@ -607,165 +455,106 @@ void animacao4(){
     int sleep = 350;  // Tempo de espera entre um frame e outro
     int sleep2 = 1100;  // Tempo de espera até limpar a matriz de leds
 
-    int frame1[5][5][3] = {
-                {{0, 0, 255}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-                {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-                {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},}
-                };
-
-    int frame2[5][5][3] = {
-                {{0, 0, 255}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 0, 0}},
-                {{0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-                {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {255, 0, 0},}
-                };
-
-    int frame3[5][5][3] = {
-                {{0, 0, 255}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 0, 0}},
-                {{0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-                {{0, 0, 0}, {0, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0},}
-                };
-
-    int frame4[5][5][3] = {
-                {{0, 0, 255}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 0, 0}},
-                {{0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-                {{255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0},}
-                };
-
-    int frame5[5][5][3] = {
-                {{0, 0, 255}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 0, 0}},
-                {{0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0}},
-                {{255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0},}
-                };
-
-    int frame6[5][5][3] = {
-                {{0, 0, 255}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 255},},
-                {{0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 0, 0}},
-                {{0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0}},
-                {{255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0},}
-                };
-
-    int frame7[5][5][3] = {
-                {{0, 0, 255}, {0, 0, 0}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255},},
-                {{0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 0, 0}},
-                {{0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0}},
-                {{255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0},}
-                };
-
-    int frame8[5][5][3] = {
-                {{0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255}, {0, 0, 255},},
-                {{0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 0, 0}},
-                {{0, 0, 0}, {0, 255, 0}, {0, 0, 0}, {0, 255, 0}, {0, 0, 0}},
-                {{255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0}, {255, 0, 0},}
-                };
-
-    int frame9[5][5][3] = {  // Limpa a matriz
-                {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},},
-                {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-                {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
-                {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0},}
-                };
-
-    print_frame(frame1, sleep);            
-    print_frame(frame2, sleep);
-    print_frame(frame3, sleep);
-    print_frame(frame4, sleep);
-    print_frame(frame5, sleep);
-    print_frame(frame6, sleep);
-    print_frame(frame7, sleep);
-    print_frame(frame8, sleep2);
-    print_frame(frame9, sleep);
+    // Cada elemento da cena é uma camada; um frame só altera as camadas que mudaram
+    const uint32_t azul = 0xFF0000FF;
+    const uint32_t verde = 0xFF00FF00;
+    const uint32_t vermelho = 0xFFFF0000;
+
+    comp_init();
+
+    // Frame 1: ponto azul no canto e primeiro ponto verde
+    comp_set_fill(0, azul, 0, 0, 1, 1);
+    comp_set_fill(1, verde, 3, 1, 1, 1);
+    comp_render();
+    sleep_ms(sleep);
+
+    // Frame 2: diagonal verde e linha vermelha entrando pela direita
+    comp_set_fill(2, verde, 2, 2, 1, 1);
+    comp_set_fill(3, verde, 1, 3, 1, 1);
+    comp_set_fill(4, vermelho, 4, 4, 5, 1);
+    comp_render();
+    sleep_ms(sleep);
+
+    // Frames 3 e 4: linha vermelha desliza até preencher a base
+    comp_move(4, 2, 4);
+    comp_render();
+    sleep_ms(sleep);
+    comp_move(4, 0, 4);
+    comp_render();
+    sleep_ms(sleep);
+
+    // Frame 5
+    comp_set_fill(5, verde, 3, 3, 1, 1);
+    comp_render();
+    sleep_ms(sleep);
+
+    // Frame 6: completa o X verde e a linha azul entra pela direita
+    comp_set_fill(6, verde, 1, 1, 1, 1);
+    comp_set_fill(7, azul, 4, 0, 5, 1);
+    comp_render();
+    sleep_ms(sleep);
+
+    // Frames 7 e 8: linha azul desliza até preencher o topo
+    comp_move(7, 2, 0);
+    comp_render();
+    sleep_ms(sleep);
+    comp_move(7, 0, 0);
+    comp_render();
+    sleep_ms(sleep2);
+
+    // Limpa a matriz
+    for (uint i = 0; i < COMP_MAX_LAYERS; i++)
+        comp_show(i, false);
+    comp_render();
+    sleep_ms(sleep);
+    npClear();
 }
 
 void animacao5() {
     int sleep_time = 500; // Tempo de espera entre os frames da animação
 
     // Definindo as cores azul e amarelo
-    int azul[3] = {0, 0, 255};
-    int amarelo[3] = {255, 255, 0};
-
-    // Frame 1: Diagonal principal azul
-    for (int linha = 0; linha < 5; linha++) {
-        for (int coluna = 0; coluna < 5; coluna++) {
-            int posicao = getIndex(linha, coluna);
-            if (linha == coluna) {
-                npSetLED(posicao, azul[0], azul[1], azul[2]);
-            } else {
-                npSetLED(posicao, amarelo[0], amarelo[1], amarelo[2]);
-            }
-        }
+    const uint32_t azul = 0x0000FF;
+    const uint32_t amarelo = 0xFFFF00;
+
+    // Formas montadas na primeira chamada: diagonal principal, diagonal
+    // secundária, bordas, cruz e X
+    static pattern_t formas[5];
+    static bool prontas = false;
+    if (!prontas) {
+        pat_diagonal(&formas[0]);
+        pat_anti_diagonal(&formas[1]);
+        pat_ring(&formas[2], 0);
+        pat_cross(&formas[3], MATRIX_WIDTH / 2, MATRIX_HEIGHT / 2);
+        pat_or(&formas[4], &formas[0], &formas[1]);
+        prontas = true;
     }
-    npWrite();
-    sleep_ms(sleep_time);
 
-    // Frame 2: Diagonal secundária azul
-    for (int linha = 0; linha < 5; linha++) {
-        for (int coluna = 0; coluna < 5; coluna++) {
-            int posicao = getIndex(linha, coluna);
-            if (linha + coluna == 4) {
-                npSetLED(posicao, azul[0], azul[1], azul[2]);
-            } else {
-                npSetLED(posicao, amarelo[0], amarelo[1], amarelo[2]);
-            }
-        }
-    }
-    npWrite();
-    sleep_ms(sleep_time);
-
-    // Frame 3: Bordas azuis
-    for (int linha = 0; linha < 5; linha++) {
-        for (int coluna = 0; coluna < 5; coluna++) {
-            int posicao = getIndex(linha, coluna);
-            if (linha == 0 || linha == 4 || coluna == 0 || coluna == 4) {
-                npSetLED(posicao, azul[0], azul[1], azul[2]);
-            } else {
-                npSetLED(posicao, amarelo[0], amarelo[1], amarelo[2]);
-            }
-        }
+    // Cada frame: a forma em azul e o restante em amarelo
+    for (int f = 0; f < 5; f++) {
+        pattern_t fundo;
+        pat_not(&fundo, &formas[f]);
+        pat_draw(&formas[f], azul);
+        pat_draw(&fundo, amarelo);
+        npWrite();
+        sleep_ms(sleep_time);
     }
-    npWrite();
-    sleep_ms(sleep_time);
 
-    // Frame 4: Cruz azul
-    for (int linha = 0; linha < 5; linha++) {
-        for (int coluna = 0; coluna < 5; coluna++) {
-            int posicao = getIndex(linha, coluna);
-            if (linha == 2 || coluna == 2) {
-                npSetLED(posicao, azul[0], azul[1], azul[2]);
-            } else {
-                npSetLED(posicao, amarelo[0], amarelo[1], amarelo[2]);
-            }
-        }
+    // Saída: o X desliza para a direita, deixando em amarelo fraco o rastro
+    // dos pixels que acabaram de apagar (os que mudaram e estavam acesos)
+    pattern_t anterior = formas[4];
+    for (int dx = 1; dx <= MATRIX_WIDTH; dx++) {
+        pattern_t atual, rastro;
+        pat_shift_x(&atual, &formas[4], dx);
+        pat_xor(&rastro, &anterior, &atual);
+        pat_and(&rastro, &rastro, &anterior);
+        npClear();
+        pat_draw(&rastro, 0x202000);
+        pat_draw(&atual, azul);
+        npWrite();
+        sleep_ms(sleep_time / 5);
+        anterior = atual;
     }
-    npWrite();
-    sleep_ms(sleep_time);
-
-    // Frame 5: X azul
-    for (int linha = 0; linha < 5; linha++) {
-        for (int coluna = 0; coluna < 5; coluna++) {
-            int posicao = getIndex(linha, coluna);
-            if (linha == coluna || linha + coluna == 4) {
-                npSetLED(posicao, azul[0], azul[1], azul[2]);
-            } else {
-                npSetLED(posicao, amarelo[0], amarelo[1], amarelo[2]);
-            }
-        }
-    }
-    npWrite();
-    sleep_ms(sleep_time);
 
     // Limpar os LEDs após a animação
     npClear();
@@ -773,6 +562,8 @@ void animacao5() {
 }
 
 void pico_keypad_control_led(char key) {
+    static const store_hdr_t *stored = NULL; // Última animação da flash reproduzida pela tecla 7
+
     switch (key) {
         case '1':
             animacao1();
@@ -789,15 +580,23 @@ void pico_keypad_control_led(char key) {
         case '5':
             animacao5();
             break;
-        case '6':
+        case '6': // Executa o programa carregado pela USB
+            if (vm_run_loaded(buzzer_pin, pico_keypad_pressed) != VM_OK)
+                printf("Nenhum programa válido carregado.\n");
             break;
-        case '7':
+        case '7': // Reproduz, a cada toque, a próxima animação gravada na flash
+            stored = store_next(stored);
+            if (!stored)
+                stored = store_next(NULL);
+            if (!stored || store_play(stored, buzzer_pin, pico_keypad_pressed) != STORE_OK)
+                printf("Nenhuma animação válida gravada.\n");
             break;
-        case '8':
+        case '8': // Rola o texto pela matriz
+            text_scroll(scroll_text, 0x0000FF, 64, pico_keypad_pressed);
             break;
         case '9':
             npClear();
-            setBrightness(255, 0, 0, 0.3, 0, 0);
+            setBrightness(0xFF0000, 30);
             break;
         case '0':
             play_musica(buzzer_pin);
@@ -809,19 +608,25 @@ void pico_keypad_control_led(char key) {
             break;
         case 'B': // 100% de luminosidade
             npClear();
-            setBrightness(0, 0, 255, 0, 0, 1); // Azul com 100% de brilho
+            setBrightness(0x0000FF, 100); // Azul com 100% de brilho
             break;
         case 'C': // 80% de luminosidade
             npClear();
-            setBrightness(255, 0, 0, 0.8, 0, 0); // Vermelho com 80% de brilho
+            setBrightness(0xFF0000, 80); // Vermelho com 80% de brilho
             break;
         case 'D': // 50% de luminosidade
             npClear();
-            setBrightness(0, 255, 0, 0, 0.5, 0); // Verde com 50% de brilho
+            setBrightness(0x00FF00, 50); // Verde com 50% de brilho
             break;
         case '#': // 20% de luminosidade
             npClear();
-            setBrightness(255, 255, 255, 0.2, 0.2, 0.2); // Cinza com 20% de brilho
+            // Acende aos poucos até 20% com o framebuffer de 16 bits, sem degraus perto do preto
+            hdr_init();
+            for (uint32_t level = 0; level <= 13107; level += 131) {
+                hdr_fill(level, level, level);
+                hdr_show(10);
+            }
+            setBrightness(0xFFFFFF, 20); // Cinza com 20% de brilho
             break;
         case '*': //Reset
             sleep_ms(1000); // Espera 1 segundo antes de reiniciar no modo bootset
@@ -833,21 +638,227 @@ void pico_keypad_control_led(char key) {
     }
 }
 
+static int usb_pending = PICO_ERROR_TIMEOUT; // Byte lido antes da hora, devolvido na próxima leitura
+
+// Lê um byte pela USB, começando pelo byte devolvido, se houver
+int usb_getchar(uint32_t timeout_us) {
+    int ch = usb_pending;
+    usb_pending = PICO_ERROR_TIMEOUT;
+    return ch != PICO_ERROR_TIMEOUT ? ch : getchar_timeout_us(timeout_us);
+}
+
+// Consome o '\n' de um fim de linha "\r\n", para que ele não seja lido como
+// o primeiro byte dos dados; qualquer outro byte é devolvido
+void usb_end_line(int ch) {
+    if (ch == '\r') {
+        int next = getchar_timeout_us(10000);
+        if (next != '\n')
+            usb_pending = next;
+    }
+}
+
+// Descarta len bytes de dados de um comando recusado, para que não sejam
+// interpretados como comandos
+void usb_discard(uint32_t len) {
+    while (len-- > 0 && usb_getchar(1000000) != PICO_ERROR_TIMEOUT)
+        ;
+}
+
+// Lê um número decimal terminado por fim de linha pela USB
+int usb_read_uint(uint32_t *value) {
+    *value = 0;
+    while (true) {
+        int ch = usb_getchar(1000000);
+        if (ch == PICO_ERROR_TIMEOUT)
+            return -1;
+        if (ch == '\n' || ch == '\r') {
+            usb_end_line(ch);
+            return 0;
+        }
+        if (ch == ' ')
+            continue;
+        if (ch < '0' || ch > '9')
+            return -1;
+        *value = *value * 10 + (ch - '0');
+    }
+}
+
+// Lê uma linha de texto pela USB
+int usb_read_line(char *buf, uint32_t size) {
+    uint32_t n = 0;
+    while (true) {
+        int ch = usb_getchar(1000000);
+        if (ch == PICO_ERROR_TIMEOUT)
+            return -1;
+        if (ch == '\n' || ch == '\r') {
+            usb_end_line(ch);
+            break;
+        }
+        if (n + 1 < size)
+            buf[n++] = ch;
+    }
+    buf[n] = '\0';
+    return 0;
+}
+
+// Lê len bytes brutos pela USB
+int usb_read_bytes(uint8_t *buf, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        int ch = usb_getchar(1000000);
+        if (ch == PICO_ERROR_TIMEOUT)
+            return -1;
+        buf[i] = ch;
+    }
+    return 0;
+}
+
+// Trata os comandos recebidos pela USB
+//   U <tamanho>\n<bytes>  carrega um programa da máquina virtual na RAM
+//   R                     executa o programa carregado
+//   S <nome> <tipo> <ms> <tamanho>\n<bytes>  grava uma animação na flash
+//   P <nome>              reproduz uma animação da flash
+//   X <nome>              apaga uma animação da flash
+//   L                     lista as animações da flash
+//   M                     mostra o uso de RAM e pilha
+//   T <texto>             troca o texto da tecla 8 e o rola na matriz
+void pico_usb_control(char cmd) {
+    uint32_t len, err_pc;
+    vm_result_t res;
+    store_result_t sres;
+    const store_hdr_t *hdr;
+    char line[64], name[STORE_NAME_LEN];
+    unsigned kind, frame_ms;
+    unsigned long size;
+    uint8_t chunk[64];
+
+    switch (cmd) {
+        case 'U':
+            if (usb_read_uint(&len) != 0) {
+                printf("ERR tamanho\n");
+                break;
+            }
+            if (len > VM_MAX_BYTES) {
+                usb_discard(len);
+                printf("ERR tamanho\n");
+                break;
+            }
+            if (usb_read_bytes(vm_upload_buffer(), len) != 0) {
+                printf("ERR timeout\n");
+                break;
+            }
+            res = vm_upload_commit(len, &err_pc);
+            if (res == VM_OK)
+                printf("OK %lu\n", (unsigned long)len);
+            else
+                printf("ERR %d pc=%lu\n", res, (unsigned long)err_pc);
+            break;
+        case 'R':
+            res = vm_run_loaded(buzzer_pin, pico_keypad_pressed);
+            if (res == VM_OK)
+                printf("OK\n");
+            else
+                printf("ERR %d\n", res);
+            break;
+        case 'S':
+            if (usb_read_line(line, sizeof(line)) != 0 ||
+                sscanf(line, "%15s %u %u %lu", name, &kind, &frame_ms, &size) != 4) {
+                printf("ERR formato\n");
+                break;
+            }
+            len = size;
+            sres = store_begin(name, kind, frame_ms, len);
+            if (sres != STORE_OK) {
+                usb_discard(len);
+                printf("ERR %d\n", sres);
+                break;
+            }
+            // Os dados são gravados na flash em partes, sem ocupar um buffer do tamanho da animação
+            for (uint32_t done = 0; sres == STORE_OK && done < len; done += sizeof(chunk)) {
+                uint32_t n = len - done < sizeof(chunk) ? len - done : sizeof(chunk);
+                if (usb_read_bytes(chunk, n) != 0) {
+                    sres = STORE_ERR_STATE;
+                    break;
+                }
+                sres = store_append(chunk, n);
+                if (sres != STORE_OK)
+                    usb_discard(len - done - n);
+            }
+            if (sres == STORE_OK)
+                sres = store_commit();
+            if (sres == STORE_OK) {
+                printf("OK %lu livres\n", (unsigned long)store_free_bytes());
+            } else {
+                store_abort();              // Sem isso, novas gravações ficariam bloqueadas
+                printf("ERR %d\n", sres);
+            }
+            break;
+        case 'P':
+        case 'X':
+            if (usb_read_line(line, sizeof(line)) != 0 || sscanf(line, "%15s", name) != 1) {
+                printf("ERR formato\n");
+                break;
+            }
+            if (cmd == 'X')
+                sres = store_delete(name);
+            else if ((hdr = store_find(name)) != NULL)
+                sres = store_play(hdr, buzzer_pin, pico_keypad_pressed);
+            else
+                sres = STORE_ERR_NOT_FOUND;
+            if (sres == STORE_OK)
+                printf("OK\n");
+            else
+                printf("ERR %d\n", sres);
+            break;
+        case 'L':
+            for (hdr = store_next(NULL); hdr; hdr = store_next(hdr))
+                printf("%s tipo=%u bytes=%lu\n", hdr->name, hdr->kind, (unsigned long)hdr->length);
+            printf("OK %lu livres\n", (unsigned long)store_free_bytes());
+            break;
+        case 'M':
+            telemetry_report();
+            break;
+        case 'T':
+            if (usb_read_line(line, sizeof(line)) != 0) {
+                printf("ERR formato\n");
+                break;
+            }
+            snprintf(scroll_text, sizeof(scroll_text), "%s", line[0] == ' ' ? line + 1 : line);
+            text_scroll(scroll_text, 0x0000FF, 64, pico_keypad_pressed);
+            printf("OK\n");
+            break;
+        case '\r':
+        case '\n':
+            break;
+        default:
+            printf("Comando '%c' não mapeado.\n", cmd);
+            break;
+    }
+}
+
 
 int main()
 {
     char key;
-    //stdio_init_all();
+    int cmd;
+    telemetry_init();                                     // Pintar as pilhas para medir o uso
+    stdio_init_all();                                     // USB usada para carregar animações
     pico_init_keypad(row_pins, col_pins);
     pico_buzzer_init(buzzer_pin);                         // Inicializar o buzzer
     npInit(LED_PIN);                                      // Inicializar os LEDs
+    store_mount();                                        // Localizar as animações gravadas na flash
     npClear();                                            // Apagar todos os LEDs
     npWrite();                                        // Atualizar o estado inicial dos LEDs
 
     while (true) {
         key = pico_scan_keypad(); 
         if (key != '\0') {
+            telemetry_begin();
             pico_keypad_control_led(key); // Executa a ação correspondente no modo padrão (LEDs)
+            telemetry_end(key);           // Registra o pico de pilha da tecla
+        }
+        cmd = usb_getchar(0);
+        if (cmd != PICO_ERROR_TIMEOUT) {
+            pico_usb_control(cmd); // Executa o comando recebido pela USB
         }
         sleep_ms(100);
     }
@@ -0,0 +1,471 @@
+#include <string.h>
+#include <stddef.h>
+#include "anim_store.h"
+#include "anim_vm.h"
+#include "neopixel.h"
+#include "hardware/sync.h"
+
+#define STORE_PAGES (STORE_SIZE / FLASH_PAGE_SIZE)
+#define STORE_SECTORS (STORE_SIZE / FLASH_SECTOR_SIZE)
+#define PAGES_PER_SECTOR (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+#define RECORD_MAX_PAGES (STORE_MAX_RECORD / FLASH_PAGE_SIZE)
+// Espaço mantido livre para que a coleta de lixo sempre consiga mover um setor
+// (registros do setor, o último podendo ter o tamanho máximo, mais o salto no fim da região)
+#define STORE_RESERVE_PAGES (2 * RECORD_MAX_PAGES + PAGES_PER_SECTOR)
+
+extern char __flash_binary_end;     // Fim do firmware na flash (definido pelo linker)
+
+static bool st_enabled = false;
+static uint32_t st_head;            // Próxima página livre
+static uint32_t st_tail;            // Primeira página do registro mais antigo
+static uint32_t st_seq;             // Próximo número de sequência
+
+// Registro sendo gravado
+static uint32_t wr_page;            // Página do cabeçalho
+static uint32_t wr_next;            // Próxima página de dados
+static uint32_t wr_written;
+static uint32_t wr_fill;
+static uint32_t wr_crc;
+static bool wr_active = false;
+static store_hdr_t wr_hdr;
+static uint8_t page_buf[FLASH_PAGE_SIZE];
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++)
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+static inline const store_hdr_t *page_ptr(uint32_t page)
+{
+    return (const store_hdr_t *)(XIP_BASE + STORE_OFFSET + page * FLASH_PAGE_SIZE);
+}
+
+static inline uint32_t record_pages(const store_hdr_t *h)
+{
+    return 1 + (h->length + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+}
+
+static bool header_valid(const store_hdr_t *h, uint32_t page)
+{
+    if (h->magic != STORE_MAGIC)
+        return false;
+    if (h->hdr_crc != crc32_update(0, (const uint8_t *)h, offsetof(store_hdr_t, hdr_crc)))
+        return false;
+    return h->length <= STORE_MAX_RECORD - FLASH_PAGE_SIZE && page + record_pages(h) <= STORE_PAGES;
+}
+
+static bool page_erased(uint32_t page)
+{
+    const uint32_t *p = (const uint32_t *)page_ptr(page);
+    for (uint i = 0; i < FLASH_PAGE_SIZE / 4; i++)
+        if (p[i] != 0xFFFFFFFF)
+            return false;
+    return true;
+}
+
+// Gravação e apagamento na flash. A execução a partir da flash fica suspensa
+// durante a operação, por isso as interrupções são desligadas e os dados de
+// origem precisam estar na RAM.
+static void flash_program_page(uint32_t page, const uint8_t *data)
+{
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_program(STORE_OFFSET + page * FLASH_PAGE_SIZE, data, FLASH_PAGE_SIZE);
+    restore_interrupts(ints);
+}
+
+static void flash_erase_sector(uint32_t sector)
+{
+    uint32_t ints = save_and_disable_interrupts();
+    flash_range_erase(STORE_OFFSET + sector * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
+    restore_interrupts(ints);
+}
+
+// Grava alguns campos de um cabeçalho já gravado. Os bytes em 0xFF não alteram a flash.
+static void header_patch(uint32_t page, size_t offset, const void *src, size_t len)
+{
+    memset(page_buf, 0xFF, FLASH_PAGE_SIZE);
+    memcpy(page_buf + offset, src, len);
+    flash_program_page(page, page_buf);
+}
+
+// Grava o CRC dos dados e a palavra commit, tornando o registro visível
+static void header_finish(uint32_t page, uint32_t data_crc)
+{
+    uint32_t words[2] = {data_crc, STORE_COMMITTED};
+    header_patch(page, offsetof(store_hdr_t, data_crc), words, sizeof(words));
+}
+
+static void header_delete(const store_hdr_t *h)
+{
+    uint32_t deleted = STORE_DELETED;
+    uint32_t page = (uint32_t)((const uint8_t *)h - (const uint8_t *)page_ptr(0)) / FLASH_PAGE_SIZE;
+    header_patch(page, offsetof(store_hdr_t, commit), &deleted, sizeof(deleted));
+}
+
+// Grava uma página de cabeçalho sem o CRC dos dados e sem commit
+static void header_write(uint32_t page, store_hdr_t *hdr)
+{
+    hdr->hdr_crc = crc32_update(0, (const uint8_t *)hdr, offsetof(store_hdr_t, hdr_crc));
+    hdr->data_crc = 0xFFFFFFFF;
+    hdr->commit = 0xFFFFFFFF;
+    memset(page_buf, 0xFF, FLASH_PAGE_SIZE);
+    memcpy(page_buf, hdr, sizeof(*hdr));
+    flash_program_page(page, page_buf);
+}
+
+// Páginas livres entre a cabeça e o início do setor da cauda
+static uint32_t free_pages(void)
+{
+    if (st_head == st_tail)
+        return STORE_PAGES - st_head % PAGES_PER_SECTOR;
+    uint32_t tail_start = st_tail - st_tail % PAGES_PER_SECTOR;
+    return (tail_start + STORE_PAGES - st_head) % STORE_PAGES;
+}
+
+// Páginas necessárias para gravar n páginas contíguas a partir da cabeça
+static uint32_t pages_needed(uint32_t n)
+{
+    if (st_head + n > STORE_PAGES)
+        return (STORE_PAGES - st_head) + n; // O fim da região é pulado
+    return n;
+}
+
+// Reserva n páginas contíguas na cabeça do log
+static uint32_t alloc_pages(uint32_t n)
+{
+    if (st_head + n > STORE_PAGES)
+        st_head = 0;
+    uint32_t page = st_head;
+    st_head = (st_head + n) % STORE_PAGES;
+    return page;
+}
+
+// Copia um registro vivo para a cabeça do log com um novo número de sequência
+static void relocate(const store_hdr_t *h)
+{
+    uint32_t n = record_pages(h);
+    uint32_t dst = alloc_pages(n);
+
+    store_hdr_t hdr = *h;
+    hdr.seq = st_seq++;
+    header_write(dst, &hdr);
+
+    const uint8_t *src = (const uint8_t *)h;
+    for (uint32_t i = 1; i < n; i++) {
+        memcpy(page_buf, src + i * FLASH_PAGE_SIZE, FLASH_PAGE_SIZE);
+        flash_program_page(dst + i, page_buf);
+    }
+    header_finish(dst, h->data_crc);
+    header_delete(h);
+}
+
+// Libera o setor mais antigo: move os registros vivos que começam nele e apaga
+// todos os setores que ficaram antes da nova cauda. Retorna false, sem apagar
+// nada, se não houver espaço para mover um registro.
+static bool gc_step(void)
+{
+    uint32_t sector = st_tail / PAGES_PER_SECTOR;
+    uint32_t pos = st_tail;
+
+    while (pos != st_head && pos / PAGES_PER_SECTOR == sector) {
+        const store_hdr_t *h = page_ptr(pos);
+        if (header_valid(h, pos)) {
+            uint32_t n = record_pages(h);
+            if (h->commit == STORE_COMMITTED) {
+                // A cópia não pode alcançar o setor da cauda, que ainda tem a origem
+                if (free_pages() < pages_needed(n)) {
+                    st_tail = pos;
+                    return false;
+                }
+                relocate(h);
+            }
+            pos += n;
+        } else {
+            pos++;
+        }
+        if (pos >= STORE_PAGES)
+            pos = 0;
+    }
+
+    st_tail = pos;
+    for (uint32_t s = sector; s != st_tail / PAGES_PER_SECTOR; s = (s + 1) % STORE_SECTORS)
+        flash_erase_sector(s);
+    return true;
+}
+
+// Apaga as versões mais antigas que keep ainda marcadas como completas. Além
+// da substituição normal, cobre cópias duplicadas deixadas por uma queda de
+// energia entre o commit de um registro e o apagamento do anterior.
+static void delete_older(const store_hdr_t *keep)
+{
+    for (const store_hdr_t *h = store_next(NULL); h; h = store_next(h))
+        if (h->seq < keep->seq && strncmp(h->name, keep->name, STORE_NAME_LEN) == 0)
+            header_delete(h);
+}
+
+// Procura o log na flash: a cauda é o registro de menor sequência e a cabeça
+// fica logo após o de maior sequência
+void store_mount(void)
+{
+    st_enabled = (uintptr_t)&__flash_binary_end <= XIP_BASE + STORE_OFFSET;
+    st_head = st_tail = st_seq = 0;
+    wr_active = false;
+    if (!st_enabled)
+        return;
+
+    uint32_t min_seq = 0xFFFFFFFF;
+    uint32_t last = 0;
+    bool found = false;
+    for (uint32_t page = 0; page < STORE_PAGES; page++) {
+        const store_hdr_t *h = page_ptr(page);
+        if (!header_valid(h, page))
+            continue;
+        if (h->seq < min_seq) {
+            min_seq = h->seq;
+            st_tail = page;
+        }
+        if (!found || h->seq >= st_seq) {
+            st_seq = h->seq + 1;
+            st_head = (page + record_pages(h)) % STORE_PAGES;
+            last = page;
+        }
+        found = true;
+    }
+
+    // O registro mais novo sem commit é uma gravação ou uma cópia da coleta de
+    // lixo interrompida. Ele ocupa parte da reserva, então o cabeçalho é
+    // invalidado e a montagem recomeça com a cabeça logo após o registro
+    // anterior; as páginas que ele usou são apagadas abaixo como lixo.
+    if (found && page_ptr(last)->commit == 0xFFFFFFFF) {
+        uint32_t invalid = 0;
+        header_patch(last, offsetof(store_hdr_t, magic), &invalid, sizeof(invalid));
+        store_mount();
+        return;
+    }
+
+    if (!found) {
+        // Região nunca usada: apaga o que houver de outros firmwares
+        for (uint32_t sector = 0; sector < STORE_SECTORS; sector++) {
+            for (uint32_t page = sector * PAGES_PER_SECTOR; page < (sector + 1) * PAGES_PER_SECTOR; page++) {
+                if (!page_erased(page)) {
+                    flash_erase_sector(sector);
+                    break;
+                }
+            }
+        }
+        return;
+    }
+
+    // Um cabeçalho gravado pela metade pode ter deixado lixo depois da cabeça:
+    // nesse caso o resto do setor é abandonado
+    for (uint32_t page = st_head; ; ) {
+        if (!page_erased(page)) {
+            st_head = (st_head - st_head % PAGES_PER_SECTOR + PAGES_PER_SECTOR) % STORE_PAGES;
+            break;
+        }
+        if (++page % PAGES_PER_SECTOR == 0)
+            break;
+    }
+
+    // A cauda é o cabeçalho mais antigo, mas o setor dela ou os anteriores
+    // podem guardar o fim de um registro cujo cabeçalho já foi apagado pela
+    // coleta de lixo. Os setores livres com restos são apagados antes de
+    // receber gravações.
+    uint32_t tail_sector = st_tail / PAGES_PER_SECTOR;
+    for (uint32_t s = (st_head + PAGES_PER_SECTOR - 1) / PAGES_PER_SECTOR % STORE_SECTORS; s != tail_sector; s = (s + 1) % STORE_SECTORS) {
+        for (uint32_t page = s * PAGES_PER_SECTOR; page < (s + 1) * PAGES_PER_SECTOR; page++) {
+            if (!page_erased(page)) {
+                flash_erase_sector(s);
+                break;
+            }
+        }
+    }
+
+    for (const store_hdr_t *h = store_next(NULL); h; h = store_next(h))
+        delete_older(h);
+}
+
+store_result_t store_begin(const char *name, uint32_t kind, uint32_t frame_ms, uint32_t length)
+{
+    if (!st_enabled)
+        return STORE_ERR_DISABLED;
+    if (wr_active)
+        return STORE_ERR_STATE;
+    if ((kind != STORE_KIND_FRAMES && kind != STORE_KIND_VM) || frame_ms > 0xFFFF)
+        return STORE_ERR_KIND;
+    if (length == 0 || length > STORE_MAX_RECORD - FLASH_PAGE_SIZE)
+        return STORE_ERR_SIZE;
+
+    uint32_t n = 1 + (length + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+    for (int tries = 0; free_pages() < pages_needed(n) + STORE_RESERVE_PAGES; tries++) {
+        if (tries == STORE_SECTORS || st_head == st_tail || !gc_step())
+            return STORE_ERR_FULL;
+    }
+
+    memset(&wr_hdr, 0, sizeof(wr_hdr));
+    wr_hdr.magic = STORE_MAGIC;
+    wr_hdr.seq = st_seq++;
+    strncpy(wr_hdr.name, name, STORE_NAME_LEN - 1);
+    wr_hdr.length = length;
+    wr_hdr.kind = kind;
+    wr_hdr.frame_ms = frame_ms;
+
+    wr_page = alloc_pages(n);
+    header_write(wr_page, &wr_hdr);
+    wr_next = wr_page + 1;
+    wr_written = 0;
+    wr_fill = 0;
+    wr_crc = 0;
+    wr_active = true;
+    return STORE_OK;
+}
+
+// Recebe os dados em partes; cada página completa é gravada imediatamente
+store_result_t store_append(const uint8_t *data, uint32_t len)
+{
+    if (!wr_active || wr_written + len > wr_hdr.length)
+        return STORE_ERR_STATE;
+
+    wr_crc = crc32_update(wr_crc, data, len);
+    wr_written += len;
+    while (len > 0) {
+        uint32_t n = FLASH_PAGE_SIZE - wr_fill;
+        if (n > len)
+            n = len;
+        memcpy(page_buf + wr_fill, data, n);
+        wr_fill += n;
+        data += n;
+        len -= n;
+        if (wr_fill == FLASH_PAGE_SIZE) {
+            flash_program_page(wr_next++, page_buf);
+            wr_fill = 0;
+        }
+    }
+    return STORE_OK;
+}
+
+// Grava a palavra commit, tornando o registro visível de forma atômica.
+// As versões anteriores com o mesmo nome são apagadas em seguida.
+store_result_t store_commit(void)
+{
+    if (!wr_active || wr_written != wr_hdr.length)
+        return STORE_ERR_STATE;
+
+    if (wr_fill > 0) {
+        memset(page_buf + wr_fill, 0xFF, FLASH_PAGE_SIZE - wr_fill);
+        flash_program_page(wr_next, page_buf);
+    }
+    wr_active = false;
+
+    header_finish(wr_page, wr_crc);
+    delete_older(page_ptr(wr_page));
+    return STORE_OK;
+}
+
+// Abandona a gravação em andamento. O cabeçalho fica sem commit, é ignorado
+// na leitura e recuperado pela coleta de lixo.
+void store_abort(void)
+{
+    wr_active = false;
+}
+
+store_result_t store_delete(const char *name)
+{
+    if (wr_active)
+        return STORE_ERR_STATE;
+    const store_hdr_t *h = store_find(name);
+    if (!h)
+        return STORE_ERR_NOT_FOUND;
+    header_delete(h);
+    return STORE_OK;
+}
+
+// Percorre os registros completos do mais antigo ao mais novo (prev = NULL para o primeiro)
+const store_hdr_t *store_next(const store_hdr_t *prev)
+{
+    if (!st_enabled)
+        return NULL;
+
+    uint32_t pos = st_tail;
+    if (prev) {
+        pos = (uint32_t)((const uint8_t *)prev - (const uint8_t *)page_ptr(0)) / FLASH_PAGE_SIZE;
+        if (header_valid(prev, pos))        // prev pode ter sido movido pela coleta de lixo
+            pos = (pos + record_pages(prev)) % STORE_PAGES;
+        else
+            pos = st_tail;
+    }
+
+    while (pos != st_head) {
+        const store_hdr_t *h = page_ptr(pos);
+        if (header_valid(h, pos)) {
+            if (h->commit == STORE_COMMITTED)
+                return h;
+            pos += record_pages(h);
+        } else {
+            pos++;
+        }
+        if (pos >= STORE_PAGES)
+            pos = 0;
+    }
+    return NULL;
+}
+
+// Retorna a versão mais recente de uma animação
+const store_hdr_t *store_find(const char *name)
+{
+    const store_hdr_t *found = NULL;
+    for (const store_hdr_t *h = store_next(NULL); h; h = store_next(h))
+        if (strncmp(h->name, name, STORE_NAME_LEN) == 0 && (!found || h->seq > found->seq))
+            found = h;
+    return found;
+}
+
+// Dados do registro, lidos no próprio endereço da flash
+const uint8_t *store_data(const store_hdr_t *hdr)
+{
+    return (const uint8_t *)hdr + FLASH_PAGE_SIZE;
+}
+
+// Espaço já apagado e pronto para gravação (sem contar o que a coleta de lixo ainda pode recuperar)
+uint32_t store_free_bytes(void)
+{
+    if (!st_enabled)
+        return 0;
+    uint32_t free = free_pages();
+    return free > STORE_RESERVE_PAGES ? (free - STORE_RESERVE_PAGES) * FLASH_PAGE_SIZE : 0;
+}
+
+// Reproduz um registro sem copiá-lo para a RAM
+store_result_t store_play(const store_hdr_t *hdr, uint buzzer_gpio, bool (*should_stop)(void))
+{
+    const uint8_t *data = store_data(hdr);
+    if (crc32_update(0, data, hdr->length) != hdr->data_crc)
+        return STORE_ERR_CRC;
+
+    if (hdr->kind == STORE_KIND_VM) {
+        uint32_t err_pc;
+        if (vm_verify((const uint32_t *)data, hdr->length, &err_pc) != VM_OK)
+            return STORE_ERR_BYTECODE;
+        vm_run((const uint32_t *)data, buzzer_gpio, should_stop);
+        return STORE_OK;
+    }
+    if (hdr->kind != STORE_KIND_FRAMES)
+        return STORE_ERR_KIND;
+
+    uint32_t frame_bytes = LED_COUNT * 3;
+    for (uint32_t off = 0; off + frame_bytes <= hdr->length; off += frame_bytes) {
+        npWriteRaw(data + off);
+        sleep_ms(hdr->frame_ms);
+        if (should_stop && should_stop())
+            break;
+    }
+    npClear();
+    npWrite();
+    return STORE_OK;
+}
@@ -0,0 +1,72 @@
+#ifndef ANIM_STORE_H
+#define ANIM_STORE_H
+
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+
+// Armazenamento de animações na flash
+//
+// As últimas STORE_SIZE bytes da flash formam um log circular de registros.
+// Cada registro ocupa uma página de cabeçalho seguida dos dados, sempre
+// contíguos, para que possam ser lidos diretamente pelo endereço XIP.
+// O cabeçalho é gravado antes dos dados, mas o registro só é válido depois
+// que a palavra commit é gravada no fim; ao substituir uma animação, a versão
+// antiga é marcada como apagada. A coleta de lixo copia os registros vivos do
+// setor mais antigo para o fim do log e apaga o setor, de forma que todos os
+// setores são usados por igual.
+
+#ifndef STORE_SIZE
+#define STORE_SIZE (512 * 1024)     // Tamanho da região reservada no fim da flash
+#endif
+#define STORE_OFFSET (PICO_FLASH_SIZE_BYTES - STORE_SIZE)
+#define STORE_NAME_LEN 16
+#define STORE_MAX_RECORD (32 * 1024) // Maior registro aceito (dados + cabeçalho)
+
+#define STORE_MAGIC 0x4D494E41      // "ANIM"
+#define STORE_COMMITTED 0x600DF00D  // Registro completo
+#define STORE_DELETED 0x00000000    // Registro substituído ou apagado
+
+// Tipos de registro
+#define STORE_KIND_FRAMES 1         // Frames GRB (3 bytes por LED, na ordem física da fita)
+#define STORE_KIND_VM 2             // Programa da máquina virtual (anim_vm.h)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;                   // Número de sequência (cresce a cada gravação)
+    char name[STORE_NAME_LEN];
+    uint32_t length;                // Bytes de dados após a página do cabeçalho
+    uint16_t kind;
+    uint16_t frame_ms;              // Duração de cada frame (STORE_KIND_FRAMES)
+    uint32_t hdr_crc;               // CRC dos campos acima
+    // Gravados só depois dos dados
+    uint32_t data_crc;
+    uint32_t commit;                // STORE_COMMITTED ou STORE_DELETED
+} store_hdr_t;
+
+typedef enum {
+    STORE_OK = 0,
+    STORE_ERR_DISABLED,             // Região reservada sobrepõe o firmware
+    STORE_ERR_SIZE,                 // Registro vazio ou maior que STORE_MAX_RECORD
+    STORE_ERR_FULL,                 // Sem espaço mesmo após a coleta de lixo
+    STORE_ERR_STATE,                // Gravação fora de ordem
+    STORE_ERR_CRC,                  // Dados corrompidos
+    STORE_ERR_NOT_FOUND,
+    STORE_ERR_KIND,                 // Tipo desconhecido ou duração de frame acima de 65535 ms
+    STORE_ERR_BYTECODE,             // Programa da máquina virtual reprovado pela verificação
+} store_result_t;
+
+void store_mount(void);
+store_result_t store_begin(const char *name, uint32_t kind, uint32_t frame_ms, uint32_t length);
+store_result_t store_append(const uint8_t *data, uint32_t len);
+store_result_t store_commit(void);
+void store_abort(void);
+store_result_t store_delete(const char *name);
+
+const store_hdr_t *store_find(const char *name);
+const store_hdr_t *store_next(const store_hdr_t *prev);
+const uint8_t *store_data(const store_hdr_t *hdr);
+uint32_t store_free_bytes(void);
+
+store_result_t store_play(const store_hdr_t *hdr, uint buzzer_gpio, bool (*should_stop)(void));
+
+#endif
@@ -0,0 +1,233 @@
+#include "anim_vm.h"
+#include "neopixel.h"
+#include "buzzer.h"
+#include "color.h"
+
+static uint32_t vm_ram[VM_MAX_BYTES / 4];   // Programa recebido pela USB
+static bool vm_ram_loaded = false;
+
+// Verifica um programa antes da execução. Como opcodes, registradores e
+// destinos de salto são validados aqui, o interpretador não precisa repetir
+// essas verificações a cada instrução.
+vm_result_t vm_verify(const uint32_t *prog, uint32_t len_bytes, uint32_t *err_pc)
+{
+    *err_pc = 0;
+    if (len_bytes % 4 != 0 || len_bytes < VM_HEADER_WORDS * 4 || len_bytes > VM_MAX_BYTES)
+        return VM_ERR_SIZE;
+    if (prog[0] != VM_MAGIC)
+        return VM_ERR_MAGIC;
+
+    uint32_t code_words = prog[1] & 0xFFFF;
+    uint32_t frame_count = prog[1] >> 16;
+    if ((prog[2] & 0xFFFF) != LED_COUNT)
+        return VM_ERR_GEOMETRY;
+    if (code_words == 0 || VM_HEADER_WORDS + code_words + frame_count * LED_COUNT != len_bytes / 4)
+        return VM_ERR_SIZE;
+
+    const uint32_t *code = prog + VM_HEADER_WORDS;
+    for (uint32_t pc = 0; pc < code_words; pc++) {
+        uint32_t w = code[pc];
+        uint32_t a = (w >> 8) & 0xF;
+        uint32_t target = w >> 16;
+        *err_pc = pc;
+
+        switch (w & 0xFF) {
+            case VM_HALT: case VM_LDI: case VM_LDHI: case VM_MOV: case VM_ADDI:
+            case VM_FILL: case VM_FRAME: case VM_WAIT: case VM_WAITI: case VM_NOTE:
+                break;
+            case VM_ADD: case VM_SUB: case VM_MUL: case VM_AND: case VM_OR:
+            case VM_XOR: case VM_SHL: case VM_SHR: case VM_PIX: case VM_TWEEN:
+                if ((w >> 20) != 0)                         // Reg c usa só os bits 16-19
+                    return VM_ERR_REG;
+                break;
+            case VM_RECT:
+                if (a > VM_REGS - 4)                        // x, y, w, h em quatro registradores seguidos
+                    return VM_ERR_REG;
+                break;
+            case VM_JMP: case VM_JZ: case VM_JNZ: case VM_LOOP: case VM_JLT:
+                if (target >= code_words)
+                    return VM_ERR_JUMP;
+                break;
+            default:
+                return VM_ERR_OPCODE;
+        }
+    }
+    return VM_OK;
+}
+
+void vm_init(vm_t *vm, const uint32_t *prog)
+{
+    vm->code = prog + VM_HEADER_WORDS;
+    vm->code_words = prog[1] & 0xFFFF;
+    vm->frame_count = prog[1] >> 16;
+    vm->frames = vm->code + vm->code_words;
+    vm->pc = 0;
+    vm->halted = false;
+    vm->error = VM_OK;
+    for (int i = 0; i < VM_REGS; i++)
+        vm->r[i] = 0;
+}
+
+// Desenha um pixel a partir de uma cor 0x00RRGGBB, ignorando coordenadas fora da matriz
+static inline void vm_pixel(int32_t x, int32_t y, uint32_t color)
+{
+    if ((uint32_t)x < MATRIX_WIDTH && (uint32_t)y < MATRIX_HEIGHT)
+        npSetLED(getIndex(x, y), color >> 16, color >> 8, color);
+}
+
+// Executa instruções até o próximo WAIT, HALT ou até esgotar VM_BUDGET. Cada
+// instrução custa 1 e cada pixel escrito custa mais 1, para que FILL, RECT e
+// FRAME não multipliquem o trabalho do frame.
+// Retorna o tempo de espera em ms antes do próximo frame, ou -1 se o programa terminou.
+int vm_step_frame(vm_t *vm, uint buzzer_gpio)
+{
+    const uint32_t *code = vm->code;
+    int32_t *r = vm->r;
+    uint32_t pc = vm->pc;
+
+    for (int32_t budget = VM_BUDGET; budget > 0; budget--) {
+        // Fim do código sem HALT. Testado antes da leitura porque um WAIT na
+        // última instrução retorna com pc == code_words.
+        if (pc >= vm->code_words) {
+            vm->halted = true;
+            return -1;
+        }
+
+        uint32_t w = code[pc++];
+        uint32_t a = (w >> 8) & 0xF;
+        uint32_t b = (w >> 12) & 0xF;
+        uint32_t c = (w >> 16) & 0xF;
+        int32_t imm = (int16_t)(w >> 16);
+
+        // A aritmética é feita sem sinal: o programa vem de fora e um estouro
+        // com sinal seria comportamento indefinido
+        switch (w & 0xFF) {
+            case VM_HALT:
+                vm->halted = true;
+                return -1;
+            case VM_LDI:  r[a] = imm; break;
+            case VM_LDHI: r[a] = (r[a] & 0xFFFF) | (int32_t)((w >> 16) << 16); break;
+            case VM_MOV:  r[a] = r[b]; break;
+            case VM_ADD:  r[a] = (int32_t)((uint32_t)r[b] + (uint32_t)r[c]); break;
+            case VM_SUB:  r[a] = (int32_t)((uint32_t)r[b] - (uint32_t)r[c]); break;
+            case VM_MUL:  r[a] = (int32_t)((uint32_t)r[b] * (uint32_t)r[c]); break;
+            case VM_AND:  r[a] = r[b] & r[c]; break;
+            case VM_OR:   r[a] = r[b] | r[c]; break;
+            case VM_XOR:  r[a] = r[b] ^ r[c]; break;
+            case VM_SHL:  r[a] = (uint32_t)r[b] << (r[c] & 31); break;
+            case VM_SHR:  r[a] = (uint32_t)r[b] >> (r[c] & 31); break;
+            case VM_ADDI: r[a] = (int32_t)((uint32_t)r[a] + (uint32_t)imm); break;
+            case VM_JMP:  pc = w >> 16; break;
+            case VM_JZ:   if (r[a] == 0) pc = w >> 16; break;
+            case VM_JNZ:  if (r[a] != 0) pc = w >> 16; break;
+            case VM_LOOP:
+                r[a] = (int32_t)((uint32_t)r[a] - 1);
+                if (r[a] != 0)
+                    pc = w >> 16;
+                break;
+            case VM_JLT:  if (r[a] < r[b]) pc = w >> 16; break;
+            case VM_PIX:
+                vm_pixel(r[a], r[b], r[c]);
+                budget--;
+                break;
+            case VM_RECT: {
+                // Recorta o retângulo na matriz antes de desenhar, em 64 bits
+                // para que a soma da posição com o tamanho não estoure
+                int64_t x0 = r[a] < 0 ? 0 : r[a];
+                int64_t y0 = r[a + 1] < 0 ? 0 : r[a + 1];
+                int64_t x1 = (int64_t)r[a] + r[a + 2];
+                int64_t y1 = (int64_t)r[a + 1] + r[a + 3];
+                if (x1 > MATRIX_WIDTH) x1 = MATRIX_WIDTH;
+                if (y1 > MATRIX_HEIGHT) y1 = MATRIX_HEIGHT;
+                if (x0 >= x1 || y0 >= y1)
+                    break;
+                for (int32_t y = y0; y < y1; y++)
+                    for (int32_t x = x0; x < x1; x++)
+                        vm_pixel(x, y, r[b]);
+                budget -= (int32_t)((x1 - x0) * (y1 - y0));
+                break;
+            }
+            case VM_FILL:
+                for (uint i = 0; i < LED_COUNT; i++)
+                    npSetLED(i, r[a] >> 16, r[a] >> 8, r[a]);
+                budget -= LED_COUNT;
+                break;
+            case VM_FRAME: {
+                if ((uint32_t)r[a] >= vm->frame_count) {
+                    vm->error = VM_ERR_FRAME;
+                    vm->halted = true;
+                    return -1;
+                }
+                const uint32_t *f = vm->frames + (uint32_t)r[a] * LED_COUNT;
+                for (int y = 0; y < MATRIX_HEIGHT; y++)
+                    for (int x = 0; x < MATRIX_WIDTH; x++, f++)
+                        npSetLED(getIndex(x, y), *f >> 16, *f >> 8, *f);
+                budget -= LED_COUNT;
+                break;
+            }
+            case VM_WAIT:
+                vm->pc = pc;
+                return r[a] > 0 ? r[a] : 0;
+            case VM_WAITI:
+                vm->pc = pc;
+                return w >> 16;
+            case VM_TWEEN: {
+                int32_t t = r[a] < 0 ? 0 : r[a] > 256 ? 256 : r[a];
+                r[a] = color_lerp(r[b], r[c], t) & 0xFFFFFF;
+                break;
+            }
+            case VM_NOTE:
+                if (r[a] > 0)
+                    pico_buzzer_play(buzzer_gpio, r[a]);
+                else
+                    pico_buzzer_stop(buzzer_gpio);
+                break;
+        }
+    }
+
+    // Orçamento esgotado: o frame é mostrado e a execução continua no próximo
+    vm->pc = pc;
+    return VM_FRAME_MS;
+}
+
+// Executa um programa já verificado até HALT ou até should_stop() retornar true
+vm_result_t vm_run(const uint32_t *prog, uint buzzer_gpio, bool (*should_stop)(void))
+{
+    vm_t vm;
+    vm_init(&vm, prog);
+    npClear();
+
+    while (true) {
+        int wait = vm_step_frame(&vm, buzzer_gpio);
+        npWrite();
+        if (wait < 0 || (should_stop && should_stop()))
+            break;
+        sleep_ms(wait);
+    }
+
+    pico_buzzer_stop(buzzer_gpio);
+    npClear();
+    npWrite();
+    return vm.error;
+}
+
+// Buffer onde o console USB escreve o programa recebido
+uint8_t *vm_upload_buffer(void)
+{
+    vm_ram_loaded = false;
+    return (uint8_t *)vm_ram;
+}
+
+vm_result_t vm_upload_commit(uint32_t len_bytes, uint32_t *err_pc)
+{
+    vm_result_t res = vm_verify(vm_ram, len_bytes, err_pc);
+    vm_ram_loaded = (res == VM_OK);
+    return res;
+}
+
+vm_result_t vm_run_loaded(uint buzzer_gpio, bool (*should_stop)(void))
+{
+    if (!vm_ram_loaded)
+        return VM_ERR_EMPTY;
+    return vm_run(vm_ram, buzzer_gpio, should_stop);
+}
@@ -0,0 +1,91 @@
+#ifndef ANIM_VM_H
+#define ANIM_VM_H
+
+#include "pico/stdlib.h"
+
+// Máquina virtual de animações
+//
+// Um programa é uma sequência de palavras de 32 bits (little-endian):
+//   [0] VM_MAGIC
+//   [1] número de instruções (16 bits baixos) | número de frames (16 bits altos)
+//   [2] pixels por frame (deve ser LED_COUNT)
+//   [3 ...] instruções, seguidas dos frames (0x00RRGGBB, linha a linha)
+//
+// Cada instrução ocupa uma palavra:
+//   bits 0-7 opcode | bits 8-11 reg a | bits 12-15 reg b | bits 16-31 imediato
+// Nas instruções de três registradores, o reg c fica nos bits 16-19.
+
+#define VM_MAGIC 0x314D5641         // "AVM1"
+#define VM_HEADER_WORDS 3
+#define VM_REGS 16                  // Registradores r0..r15 de 32 bits
+#define VM_MAX_BYTES 8192           // Tamanho máximo de um programa carregado na RAM
+#define VM_BUDGET 2048              // Trabalho máximo por frame: 1 por instrução e 1 por pixel escrito
+#define VM_FRAME_MS 16              // Duração do frame quando o orçamento se esgota (~60 fps)
+
+// Montagem de instruções
+#define VM_OP(op, a, b, c)  ((uint32_t)(op) | ((uint32_t)(a) << 8) | ((uint32_t)(b) << 12) | ((uint32_t)(c) << 16))
+#define VM_OPI(op, a, b, imm) ((uint32_t)(op) | ((uint32_t)(a) << 8) | ((uint32_t)(b) << 12) | ((uint32_t)(uint16_t)(imm) << 16))
+
+enum vm_opcode {
+    VM_HALT  = 0x00,                // Encerra o programa
+    VM_LDI   = 0x01,                // r[a] = imm (com sinal)
+    VM_LDHI  = 0x02,                // r[a] = (r[a] & 0xFFFF) | imm << 16
+    VM_MOV   = 0x03,                // r[a] = r[b]
+    VM_ADD   = 0x04,                // r[a] = r[b] + r[c]
+    VM_SUB   = 0x05,                // r[a] = r[b] - r[c]
+    VM_MUL   = 0x06,                // r[a] = r[b] * r[c]
+    VM_AND   = 0x07,                // r[a] = r[b] & r[c]
+    VM_OR    = 0x08,                // r[a] = r[b] | r[c]
+    VM_XOR   = 0x09,                // r[a] = r[b] ^ r[c]
+    VM_SHL   = 0x0A,                // r[a] = r[b] << r[c]
+    VM_SHR   = 0x0B,                // r[a] = r[b] >> r[c] (lógico)
+    VM_ADDI  = 0x0C,                // r[a] += imm
+    VM_JMP   = 0x10,                // pc = imm
+    VM_JZ    = 0x11,                // se r[a] == 0, pc = imm
+    VM_JNZ   = 0x12,                // se r[a] != 0, pc = imm
+    VM_LOOP  = 0x13,                // se --r[a] != 0, pc = imm
+    VM_JLT   = 0x14,                // se r[a] < r[b], pc = imm
+    VM_PIX   = 0x20,                // pixel (r[a], r[b]) = cor r[c]
+    VM_RECT  = 0x21,                // retângulo x=r[a] y=r[a+1] w=r[a+2] h=r[a+3] com cor r[b]
+    VM_FILL  = 0x22,                // preenche a matriz com a cor r[a]
+    VM_FRAME = 0x23,                // carrega o frame r[a] da seção de dados
+    VM_WAIT  = 0x30,                // mostra o frame e espera r[a] ms
+    VM_WAITI = 0x31,                // mostra o frame e espera imm ms
+    VM_TWEEN = 0x40,                // r[a] = interpolação entre as cores r[b] e r[c], com t = r[a] (0..256)
+    VM_NOTE  = 0x50,                // toca a frequência r[a] no buzzer (0 para silenciar), limitada à faixa do buzzer
+};
+
+typedef enum {
+    VM_OK = 0,
+    VM_ERR_SIZE,                    // Tamanho inválido ou maior que VM_MAX_BYTES
+    VM_ERR_MAGIC,                   // Cabeçalho inválido
+    VM_ERR_GEOMETRY,                // Frames com número de pixels diferente de LED_COUNT
+    VM_ERR_OPCODE,                  // Opcode desconhecido
+    VM_ERR_REG,                     // Registrador fora do intervalo
+    VM_ERR_JUMP,                    // Destino de salto fora do código
+    VM_ERR_FRAME,                   // Índice de frame inválido em tempo de execução
+    VM_ERR_EMPTY,                   // Nenhum programa carregado
+} vm_result_t;
+
+// Estado de execução de um programa
+typedef struct {
+    const uint32_t *code;           // Primeira instrução
+    const uint32_t *frames;         // Seção de frames
+    uint16_t code_words;
+    uint16_t frame_count;
+    uint16_t pc;
+    bool halted;
+    vm_result_t error;              // Erro de execução, se houver
+    int32_t r[VM_REGS];
+} vm_t;
+
+vm_result_t vm_verify(const uint32_t *prog, uint32_t len_bytes, uint32_t *err_pc);
+void vm_init(vm_t *vm, const uint32_t *prog);
+int vm_step_frame(vm_t *vm, uint buzzer_gpio);
+vm_result_t vm_run(const uint32_t *prog, uint buzzer_gpio, bool (*should_stop)(void));
+
+uint8_t *vm_upload_buffer(void);
+vm_result_t vm_upload_commit(uint32_t len_bytes, uint32_t *err_pc);
+vm_result_t vm_run_loaded(uint buzzer_gpio, bool (*should_stop)(void));
+
+#endif
@@ -0,0 +1,33 @@
+#include "buzzer.h"
+#include "hardware/pwm.h"
+
+//função para inicializar o buzzer
+void pico_buzzer_init(uint gpio) {
+    gpio_set_function(gpio, GPIO_FUNC_PWM);
+    uint slice_num = pwm_gpio_to_slice_num(gpio);
+    pwm_set_enabled(slice_num, true);
+}
+
+//função para tocar uma nota no buzzer
+void pico_buzzer_play(uint gpio, uint frequency) {
+    uint slice_num = pwm_gpio_to_slice_num(gpio);
+    uint32_t clock = 125000000;
+    if (frequency < BUZZER_MIN_FREQ)
+        frequency = BUZZER_MIN_FREQ;
+    if (frequency > BUZZER_MAX_FREQ)
+        frequency = BUZZER_MAX_FREQ;
+    uint32_t divider = clock / (frequency * 4096);
+    uint32_t wrap = (clock / divider) / frequency - 1;
+    uint32_t level = wrap / 2;
+    pwm_set_clkdiv(slice_num, divider);
+    pwm_set_wrap(slice_num, wrap);
+    pwm_set_chan_level(slice_num, PWM_CHAN_A, level);
+    pwm_set_enabled(slice_num, true);
+}
+
+//função para parar o buzzer
+void pico_buzzer_stop(uint gpio) {
+    uint slice_num = pwm_gpio_to_slice_num(gpio);
+    pwm_set_chan_level(slice_num, PWM_CHAN_A, 0);
+    pwm_set_enabled(slice_num, false);
+}
@@ -0,0 +1,15 @@
+#ifndef BUZZER_H
+#define BUZZER_H
+
+#include "pico/stdlib.h"
+
+// Faixa de frequências que o divisor de 8 bits do PWM consegue gerar com
+// wrap de pelo menos 4096 passos; valores fora dela são limitados
+#define BUZZER_MIN_FREQ 120
+#define BUZZER_MAX_FREQ 30000
+
+void pico_buzzer_init(uint gpio);
+void pico_buzzer_play(uint gpio, uint frequency);
+void pico_buzzer_stop(uint gpio);
+
+#endif
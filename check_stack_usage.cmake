@@ -0,0 +1,43 @@
+# Verifica o uso de pilha por função gerado com -fstack-usage
+#
+# Uso: cmake -DSU_DIR=<diretório dos .su> -DSTACK_BUDGET=<bytes> -P check_stack_usage.cmake
+#
+# Lista as funções do projeto que mais usam pilha e falha o build quando
+# alguma passa do orçamento ou tem uso dinâmico (alloca, VLA).
+
+file(GLOB SU_FILES "${SU_DIR}/*.su")
+
+set(FAILED FALSE)
+set(REPORT "")
+foreach(SU_FILE ${SU_FILES})
+    file(STRINGS ${SU_FILE} LINES)
+    foreach(LINE ${LINES})
+        # Formato: arquivo:linha:coluna:função<TAB>bytes<TAB>static|dynamic|dynamic,bounded
+        string(REPLACE "\t" ";" FIELDS "${LINE}")
+        list(GET FIELDS 0 LOCATION)
+        list(GET FIELDS 1 BYTES)
+        list(GET FIELDS 2 KIND)
+        string(REGEX REPLACE "^.*:" "" FUNC "${LOCATION}")
+        get_filename_component(SRC ${SU_FILE} NAME_WE)
+
+        if(BYTES GREATER STACK_BUDGET)
+            message(SEND_ERROR "${SRC}: ${FUNC} usa ${BYTES} bytes de pilha (orçamento ${STACK_BUDGET})")
+            set(FAILED TRUE)
+        elseif(KIND STREQUAL "dynamic")
+            message(SEND_ERROR "${SRC}: ${FUNC} usa pilha dinâmica")
+            set(FAILED TRUE)
+        endif()
+        if(BYTES GREATER 127)
+            list(APPEND REPORT "${BYTES}\t${SRC}: ${FUNC}")
+        endif()
+    endforeach()
+endforeach()
+
+list(SORT REPORT COMPARE NATURAL ORDER DESCENDING)
+foreach(ENTRY ${REPORT})
+    message(STATUS "pilha: ${ENTRY}")
+endforeach()
+
+if(FAILED)
+    message(FATAL_ERROR "Orçamento de pilha excedido")
+endif()
@@ -0,0 +1,47 @@
+#include "color.h"
+
+// HSV para RGB só com inteiros. O matiz h percorre os 6 setores do círculo
+// em 256 passos; s e v vão de 0 a 255.
+uint32_t color_hsv(uint8_t h, uint8_t s, uint8_t v)
+{
+    uint32_t pos = h * 6u;
+    uint32_t region = pos >> 8;
+    uint32_t rem = pos & 0xFF;
+
+    uint32_t p = (v * (256u - s)) >> 8;
+    uint32_t q = (v * (256u - ((s * rem) >> 8))) >> 8;
+    uint32_t t = (v * (256u - ((s * (256u - rem)) >> 8))) >> 8;
+
+    switch (region) {
+        case 0:  return color_rgb(v, t, p);
+        case 1:  return color_rgb(q, v, p);
+        case 2:  return color_rgb(p, v, t);
+        case 3:  return color_rgb(p, q, v);
+        case 4:  return color_rgb(t, p, v);
+        default: return color_rgb(v, p, q);
+    }
+}
+
+void color_fill_buf(uint32_t *buf, uint n, uint32_t c)
+{
+    for (uint i = 0; i < n; i++)
+        buf[i] = c;
+}
+
+void color_scale_buf(uint32_t *buf, uint n, uint32_t k)
+{
+    for (uint i = 0; i < n; i++)
+        buf[i] = color_scale(buf[i], k);
+}
+
+void color_lerp_buf(uint32_t *dst, const uint32_t *a, const uint32_t *b, uint n, uint32_t t)
+{
+    for (uint i = 0; i < n; i++)
+        dst[i] = color_lerp(a[i], b[i], t);
+}
+
+void color_add_buf(uint32_t *dst, const uint32_t *src, uint n)
+{
+    for (uint i = 0; i < n; i++)
+        dst[i] = color_add(dst[i], src[i]);
+}
@@ -0,0 +1,55 @@
+#ifndef COLOR_H
+#define COLOR_H
+
+#include "pico/stdlib.h"
+
+// Matemática de cores em pixels empacotados 0xAARRGGBB
+//
+// As funções tratam dois canais por operação (SWAR): a máscara 0x00FF00FF
+// separa vermelho e azul, e o mesmo é feito com alfa e verde depois de um
+// deslocamento de 8 bits. Cada canal fica com 16 bits de folga, então uma
+// multiplicação por até 256 não invade o canal vizinho. Tudo é inteiro,
+// já que o M0+ não tem FPU.
+
+#define COLOR_RB_MASK 0x00FF00FFu
+
+static inline uint32_t color_rgb(uint8_t r, uint8_t g, uint8_t b)
+{
+    return (uint32_t)r << 16 | (uint32_t)g << 8 | b;
+}
+
+// Escala todos os canais por k/256 (k de 0 a 256)
+static inline uint32_t color_scale(uint32_t c, uint32_t k)
+{
+    uint32_t rb = ((c & COLOR_RB_MASK) * k) >> 8;
+    uint32_t ag = (((c >> 8) & COLOR_RB_MASK) * k) >> 8;
+    return (rb & COLOR_RB_MASK) | ((ag & COLOR_RB_MASK) << 8);
+}
+
+// Interpola de a até b com t/256 (t de 0 a 256). Cada canal de
+// a*256 + (b - a)*t fica entre 0 e 0xFF00, então os empréstimos entre
+// canais se cancelam e basta uma multiplicação por par de canais.
+static inline uint32_t color_lerp(uint32_t a, uint32_t b, uint32_t t)
+{
+    uint32_t a_rb = a & COLOR_RB_MASK, b_rb = b & COLOR_RB_MASK;
+    uint32_t a_ag = (a >> 8) & COLOR_RB_MASK, b_ag = (b >> 8) & COLOR_RB_MASK;
+    uint32_t rb = ((a_rb << 8) + (b_rb - a_rb) * t) >> 8;
+    uint32_t ag = ((a_ag << 8) + (b_ag - a_ag) * t) >> 8;
+    return (rb & COLOR_RB_MASK) | ((ag & COLOR_RB_MASK) << 8);
+}
+
+// Soma com saturação em 255, os quatro canais de uma vez
+static inline uint32_t color_add(uint32_t a, uint32_t b)
+{
+    uint32_t sum = ((a & 0x7F7F7F7Fu) + (b & 0x7F7F7F7Fu)) ^ ((a ^ b) & 0x80808080u);
+    uint32_t carry = ((a & b) | ((a | b) & ~sum)) & 0x80808080u;
+    return sum | ((carry >> 7) * 0xFF);
+}
+
+uint32_t color_hsv(uint8_t h, uint8_t s, uint8_t v);
+void color_fill_buf(uint32_t *buf, uint n, uint32_t c);
+void color_scale_buf(uint32_t *buf, uint n, uint32_t k);
+void color_lerp_buf(uint32_t *dst, const uint32_t *a, const uint32_t *b, uint n, uint32_t t);
+void color_add_buf(uint32_t *dst, const uint32_t *src, uint n);
+
+#endif
@@ -0,0 +1,135 @@
+#include "compositor.h"
+#include "neopixel.h"
+#include "color.h"
+
+static comp_layer_t layers[COMP_MAX_LAYERS];
+static uint32_t comp_fb[LED_COUNT];     // Resultado da composição (0x00RRGGBB), linha a linha
+
+// Região a recompor no próximo comp_render (x1 e y1 exclusivos)
+static int16_t dirty_x0, dirty_y0, dirty_x1, dirty_y1;
+
+// Acrescenta à região suja o retângulo ocupado por uma camada visível
+static void mark_dirty(const comp_layer_t *l)
+{
+    if (!l->visible)
+        return;
+    int16_t x0 = l->x < 0 ? 0 : l->x;
+    int16_t y0 = l->y < 0 ? 0 : l->y;
+    int16_t x1 = l->x + l->w > MATRIX_WIDTH ? MATRIX_WIDTH : l->x + l->w;
+    int16_t y1 = l->y + l->h > MATRIX_HEIGHT ? MATRIX_HEIGHT : l->y + l->h;
+    if (x0 >= x1 || y0 >= y1)
+        return;
+    if (x0 < dirty_x0) dirty_x0 = x0;
+    if (y0 < dirty_y0) dirty_y0 = y0;
+    if (x1 > dirty_x1) dirty_x1 = x1;
+    if (y1 > dirty_y1) dirty_y1 = y1;
+}
+
+static void clear_dirty(void)
+{
+    dirty_x0 = MATRIX_WIDTH;
+    dirty_y0 = MATRIX_HEIGHT;
+    dirty_x1 = 0;
+    dirty_y1 = 0;
+}
+
+void comp_init(void)
+{
+    for (uint i = 0; i < COMP_MAX_LAYERS; i++)
+        layers[i].visible = false;
+    for (uint i = 0; i < LED_COUNT; i++)
+        comp_fb[i] = 0;
+    npClear();                          // Mantém leds igual a comp_fb
+    // Força o envio da matriz inteira no primeiro quadro
+    dirty_x0 = 0;
+    dirty_y0 = 0;
+    dirty_x1 = MATRIX_WIDTH;
+    dirty_y1 = MATRIX_HEIGHT;
+}
+
+void comp_set_fill(uint layer, uint32_t color, int16_t x, int16_t y, uint8_t w, uint8_t h)
+{
+    comp_layer_t *l = &layers[layer];
+    mark_dirty(l);
+    l->pixels = NULL;
+    l->color = color;
+    l->x = x;
+    l->y = y;
+    l->w = w;
+    l->h = h;
+    l->alpha = 255;
+    l->visible = true;
+    mark_dirty(l);
+}
+
+void comp_set_sprite(uint layer, const uint32_t *pixels, int16_t x, int16_t y, uint8_t w, uint8_t h)
+{
+    comp_set_fill(layer, 0, x, y, w, h);
+    layers[layer].pixels = pixels;
+}
+
+void comp_move(uint layer, int16_t x, int16_t y)
+{
+    comp_layer_t *l = &layers[layer];
+    if (l->x == x && l->y == y)
+        return;
+    mark_dirty(l);
+    l->x = x;
+    l->y = y;
+    mark_dirty(l);
+}
+
+void comp_set_alpha(uint layer, uint8_t alpha)
+{
+    comp_layer_t *l = &layers[layer];
+    if (l->alpha == alpha)
+        return;
+    l->alpha = alpha;
+    mark_dirty(l);
+}
+
+void comp_show(uint layer, bool visible)
+{
+    comp_layer_t *l = &layers[layer];
+    if (l->visible == visible)
+        return;
+    mark_dirty(l);
+    l->visible = visible;
+    mark_dirty(l);
+}
+
+// Recompõe a região suja e atualiza os LEDs. Retorna false se nada mudou.
+bool comp_render(void)
+{
+    if (dirty_x0 >= dirty_x1 || dirty_y0 >= dirty_y1)
+        return false;
+
+    for (int y = dirty_y0; y < dirty_y1; y++) {
+        for (int x = dirty_x0; x < dirty_x1; x++) {
+            uint32_t c = 0;
+            for (uint i = 0; i < COMP_MAX_LAYERS; i++) {
+                const comp_layer_t *l = &layers[i];
+                int lx = x - l->x, ly = y - l->y;
+                if (!l->visible || (uint)lx >= l->w || (uint)ly >= l->h)
+                    continue;
+                uint32_t src = l->pixels ? l->pixels[ly * l->w + lx] : l->color;
+                // Alfa do pixel vezes alfa da camada, levado para 0..256
+                uint32_t a = ((src >> 24) * (l->alpha + 1)) >> 8;
+                a += a >> 7;
+                if (a == 256)
+                    c = src & 0xFFFFFF;
+                else if (a != 0)
+                    c = color_lerp(c, src, a) & 0xFFFFFF;
+            }
+            uint32_t *fb = &comp_fb[y * MATRIX_WIDTH + x];
+            if (*fb != c) {
+                *fb = c;
+                npSetLED(getIndex(x, y), c >> 16, c >> 8, c);
+            }
+        }
+    }
+
+    clear_dirty();
+    npWrite();
+    return true;
+}
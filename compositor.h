@@ -0,0 +1,32 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include "pico/stdlib.h"
+
+// Compositor de camadas
+//
+// Cada camada é um retângulo posicionado na matriz, preenchido com uma cor
+// sólida ou com os pixels de um sprite (0xAARRGGBB, linha a linha). As camadas
+// são misturadas de baixo para cima com alfa inteiro. Só a região que mudou
+// desde o último quadro é recomposta e enviada aos LEDs.
+
+#define COMP_MAX_LAYERS 8
+
+typedef struct {
+    const uint32_t *pixels;         // Sprite 0xAARRGGBB; NULL para cor sólida
+    uint32_t color;                 // Cor 0xAARRGGBB usada quando pixels == NULL
+    int16_t x, y;                   // Posição do canto superior esquerdo (pode sair da matriz)
+    uint8_t w, h;
+    uint8_t alpha;                  // Opacidade da camada inteira (255 = opaca)
+    bool visible;
+} comp_layer_t;
+
+void comp_init(void);
+void comp_set_fill(uint layer, uint32_t color, int16_t x, int16_t y, uint8_t w, uint8_t h);
+void comp_set_sprite(uint layer, const uint32_t *pixels, int16_t x, int16_t y, uint8_t w, uint8_t h);
+void comp_move(uint layer, int16_t x, int16_t y);
+void comp_set_alpha(uint layer, uint8_t alpha);
+void comp_show(uint layer, bool visible);
+bool comp_render(void);
+
+#endif
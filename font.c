@@ -0,0 +1,170 @@
+#include "font.h"
+#include "neopixel.h"
+#include "color.h"
+
+// Monta um glifo a partir de 5 linhas alinhadas à esquerda (bit 4 = coluna 0)
+#define GLYPH_BIT(r, y, x) ((((uint32_t)(r) >> (4 - (x))) & 1u) << ((x) * 5 + (y)))
+#define GLYPH_ROW(r, y) (GLYPH_BIT(r, y, 0) | GLYPH_BIT(r, y, 1) | GLYPH_BIT(r, y, 2) | \
+                         GLYPH_BIT(r, y, 3) | GLYPH_BIT(r, y, 4))
+#define GLYPH(w, r0, r1, r2, r3, r4) ((uint32_t)(w) << 29 | GLYPH_ROW(r0, 0) | GLYPH_ROW(r1, 1) | \
+                                      GLYPH_ROW(r2, 2) | GLYPH_ROW(r3, 3) | GLYPH_ROW(r4, 4))
+
+// Glifos de ' ' a 'Z', calculados em tempo de compilação e guardados na flash
+static const uint32_t font[FONT_LAST - FONT_FIRST + 1] = {
+    GLYPH(2, 0b00000, 0b00000, 0b00000, 0b00000, 0b00000), // ' '
+    GLYPH(1, 0b10000, 0b10000, 0b10000, 0b00000, 0b10000), // '!'
+    GLYPH(3, 0b10100, 0b10100, 0b00000, 0b00000, 0b00000), // '"'
+    GLYPH(5, 0b01010, 0b11111, 0b01010, 0b11111, 0b01010), // '#'
+    GLYPH(3, 0b01100, 0b11000, 0b01000, 0b01100, 0b11000), // '$'
+    GLYPH(3, 0b10100, 0b00100, 0b01000, 0b10000, 0b10100), // '%'
+    GLYPH(4, 0b01000, 0b10100, 0b01000, 0b10100, 0b01010), // '&'
+    GLYPH(1, 0b10000, 0b10000, 0b00000, 0b00000, 0b00000), // '\''
+    GLYPH(2, 0b01000, 0b10000, 0b10000, 0b10000, 0b01000), // '('
+    GLYPH(2, 0b10000, 0b01000, 0b01000, 0b01000, 0b10000), // ')'
+    GLYPH(3, 0b10100, 0b01000, 0b10100, 0b00000, 0b00000), // '*'
+    GLYPH(3, 0b00000, 0b01000, 0b11100, 0b01000, 0b00000), // '+'
+    GLYPH(2, 0b00000, 0b00000, 0b00000, 0b01000, 0b10000), // ','
+    GLYPH(3, 0b00000, 0b00000, 0b11100, 0b00000, 0b00000), // '-'
+    GLYPH(1, 0b00000, 0b00000, 0b00000, 0b00000, 0b10000), // '.'
+    GLYPH(3, 0b00100, 0b00100, 0b01000, 0b10000, 0b10000), // '/'
+    GLYPH(3, 0b11100, 0b10100, 0b10100, 0b10100, 0b11100), // '0'
+    GLYPH(3, 0b01000, 0b11000, 0b01000, 0b01000, 0b11100), // '1'
+    GLYPH(3, 0b11100, 0b00100, 0b11100, 0b10000, 0b11100), // '2'
+    GLYPH(3, 0b11100, 0b00100, 0b11100, 0b00100, 0b11100), // '3'
+    GLYPH(3, 0b10100, 0b10100, 0b11100, 0b00100, 0b00100), // '4'
+    GLYPH(3, 0b11100, 0b10000, 0b11100, 0b00100, 0b11100), // '5'
+    GLYPH(3, 0b11100, 0b10000, 0b11100, 0b10100, 0b11100), // '6'
+    GLYPH(3, 0b11100, 0b00100, 0b01000, 0b01000, 0b01000), // '7'
+    GLYPH(3, 0b11100, 0b10100, 0b11100, 0b10100, 0b11100), // '8'
+    GLYPH(3, 0b11100, 0b10100, 0b11100, 0b00100, 0b11100), // '9'
+    GLYPH(1, 0b00000, 0b10000, 0b00000, 0b10000, 0b00000), // ':'
+    GLYPH(2, 0b00000, 0b01000, 0b00000, 0b01000, 0b10000), // ';'
+    GLYPH(3, 0b00100, 0b01000, 0b10000, 0b01000, 0b00100), // '<'
+    GLYPH(3, 0b00000, 0b11100, 0b00000, 0b11100, 0b00000), // '='
+    GLYPH(3, 0b10000, 0b01000, 0b00100, 0b01000, 0b10000), // '>'
+    GLYPH(3, 0b11100, 0b00100, 0b01100, 0b00000, 0b01000), // '?'
+    GLYPH(4, 0b01100, 0b10010, 0b10110, 0b10000, 0b01110), // '@'
+    GLYPH(3, 0b01000, 0b10100, 0b11100, 0b10100, 0b10100), // 'A'
+    GLYPH(3, 0b11000, 0b10100, 0b11000, 0b10100, 0b11000), // 'B'
+    GLYPH(3, 0b01100, 0b10000, 0b10000, 0b10000, 0b01100), // 'C'
+    GLYPH(3, 0b11000, 0b10100, 0b10100, 0b10100, 0b11000), // 'D'
+    GLYPH(3, 0b11100, 0b10000, 0b11000, 0b10000, 0b11100), // 'E'
+    GLYPH(3, 0b11100, 0b10000, 0b11000, 0b10000, 0b10000), // 'F'
+    GLYPH(4, 0b01110, 0b10000, 0b10110, 0b10010, 0b01110), // 'G'
+    GLYPH(3, 0b10100, 0b10100, 0b11100, 0b10100, 0b10100), // 'H'
+    GLYPH(3, 0b11100, 0b01000, 0b01000, 0b01000, 0b11100), // 'I'
+    GLYPH(3, 0b00100, 0b00100, 0b00100, 0b10100, 0b01000), // 'J'
+    GLYPH(3, 0b10100, 0b10100, 0b11000, 0b10100, 0b10100), // 'K'
+    GLYPH(3, 0b10000, 0b10000, 0b10000, 0b10000, 0b11100), // 'L'
+    GLYPH(5, 0b10001, 0b11011, 0b10101, 0b10001, 0b10001), // 'M'
+    GLYPH(4, 0b10010, 0b11010, 0b10110, 0b10010, 0b10010), // 'N'
+    GLYPH(4, 0b01100, 0b10010, 0b10010, 0b10010, 0b01100), // 'O'
+    GLYPH(3, 0b11000, 0b10100, 0b11000, 0b10000, 0b10000), // 'P'
+    GLYPH(4, 0b01100, 0b10010, 0b10010, 0b10110, 0b01110), // 'Q'
+    GLYPH(3, 0b11000, 0b10100, 0b11000, 0b10100, 0b10100), // 'R'
+    GLYPH(3, 0b01100, 0b10000, 0b01000, 0b00100, 0b11000), // 'S'
+    GLYPH(3, 0b11100, 0b01000, 0b01000, 0b01000, 0b01000), // 'T'
+    GLYPH(3, 0b10100, 0b10100, 0b10100, 0b10100, 0b11100), // 'U'
+    GLYPH(3, 0b10100, 0b10100, 0b10100, 0b10100, 0b01000), // 'V'
+    GLYPH(5, 0b10001, 0b10001, 0b10101, 0b11011, 0b10001), // 'W'
+    GLYPH(3, 0b10100, 0b10100, 0b01000, 0b10100, 0b10100), // 'X'
+    GLYPH(3, 0b10100, 0b10100, 0b01000, 0b01000, 0b01000), // 'Y'
+    GLYPH(3, 0b11100, 0b00100, 0b01000, 0b10000, 0b11100), // 'Z'
+};
+
+// Glifo de um caractere; minúsculas usam as maiúsculas e o resto vira '?'
+uint32_t font_glyph(char c)
+{
+    if (c >= 'a' && c <= 'z')
+        c -= 'a' - 'A';
+    if (c < FONT_FIRST || c > FONT_LAST)
+        c = '?';
+    return font[c - FONT_FIRST];
+}
+
+// Coluna atual do texto (bit 0 = linha de cima)
+static uint32_t column_at(const text_scroll_t *s)
+{
+    if (s->lead > 0 || *s->p == '\0')
+        return 0;
+    uint32_t g = font_glyph(*s->p);
+    if (s->col >= g >> 29)
+        return 0;                   // Coluna de espaçamento entre os caracteres
+    return (g >> (s->col * 5)) & 0x1F;
+}
+
+static void column_advance(text_scroll_t *s)
+{
+    if (s->lead > 0) {
+        s->lead--;
+    } else if (*s->p != '\0') {
+        if (++s->col > font_glyph(*s->p) >> 29) {
+            s->p++;
+            s->col = 0;
+        }
+    }
+}
+
+// O texto começa fora da matriz, à direita
+void text_scroll_init(text_scroll_t *s, const char *text, uint32_t color)
+{
+    s->p = text;
+    s->col = 0;
+    s->lead = MATRIX_WIDTH;
+    s->frac = 0;
+    s->color = color;
+}
+
+// Avança speed/256 colunas. Retorna false quando o texto já saiu da matriz.
+bool text_scroll_step(text_scroll_t *s, uint speed)
+{
+    uint32_t pos = s->frac + speed;
+    s->frac = pos & 0xFF;
+    for (pos >>= 8; pos > 0; pos--)
+        column_advance(s);
+    return s->lead > 0 || *s->p != '\0';
+}
+
+// Desenha o texto nas linhas centrais da matriz. Com rolagem fracionária, cada
+// coluna da tela mistura duas colunas do texto: as máscaras separam os pixels
+// acesos nas duas, só na esquerda e só na direita.
+void text_scroll_draw(const text_scroll_t *s)
+{
+    const int y0 = (MATRIX_HEIGHT - FONT_HEIGHT) / 2;
+    uint32_t both = s->color;
+    uint32_t left = color_scale(s->color, 256 - s->frac);
+    uint32_t right = color_scale(s->color, s->frac);
+
+    text_scroll_t it = *s;
+    uint32_t c0 = column_at(&it);
+    column_advance(&it);
+
+    for (int x = 0; x < MATRIX_WIDTH; x++) {
+        uint32_t c1 = column_at(&it);
+        column_advance(&it);
+
+        for (int y = 0; y < FONT_HEIGHT; y++) {
+            uint32_t bits = ((c0 >> y) & 1) | ((c1 >> y) & 1) << 1;
+            uint32_t c = bits == 3 ? both : bits == 1 ? left : bits == 2 ? right : 0;
+            npSetLED(getIndex(x, y0 + y), c >> 16, c >> 8, c);
+        }
+        c0 = c1;
+    }
+}
+
+// Rola um texto inteiro a ~60 quadros por segundo
+void text_scroll(const char *text, uint32_t color, uint speed, bool (*should_stop)(void))
+{
+    text_scroll_t s;
+    text_scroll_init(&s, text, color);
+    npClear();
+
+    do {
+        text_scroll_draw(&s);
+        npWrite();
+        sleep_ms(16);
+    } while (text_scroll_step(&s, speed) && !(should_stop && should_stop()));
+
+    npClear();
+    npWrite();
+}
@@ -0,0 +1,32 @@
+#ifndef FONT_H
+#define FONT_H
+
+#include "pico/stdlib.h"
+
+// Fonte 5x5 de 1 bit por pixel e texto com rolagem suave
+//
+// Cada glifo cabe em uma palavra de 32 bits, organizada por colunas: a
+// coluna x ocupa os bits 5x a 5x+4 (bit 5x = linha de cima) e os bits
+// 29-31 guardam a largura do glifo. Assim, uma coluna é obtida com um
+// deslocamento e uma máscara.
+
+#define FONT_HEIGHT 5
+#define FONT_FIRST ' '
+#define FONT_LAST 'Z'
+
+// Estado de um texto rolando da direita para a esquerda
+typedef struct {
+    const char *p;                  // Caractere da coluna mais à esquerda
+    uint8_t col;                    // Coluna dentro desse caractere (a última é o espaçamento)
+    uint8_t lead;                   // Colunas vazias que ainda faltam antes do texto
+    uint8_t frac;                   // Fração de coluna já rolada (1/256)
+    uint32_t color;                 // Cor 0x00RRGGBB
+} text_scroll_t;
+
+uint32_t font_glyph(char c);
+void text_scroll_init(text_scroll_t *s, const char *text, uint32_t color);
+bool text_scroll_step(text_scroll_t *s, uint speed);
+void text_scroll_draw(const text_scroll_t *s);
+void text_scroll(const char *text, uint32_t color, uint speed, bool (*should_stop)(void));
+
+#endif
@@ -0,0 +1,61 @@
+#include "hdr.h"
+#include "neopixel.h"
+
+// Canais na ordem enviada aos LEDs: verde, vermelho, azul
+static uint16_t hdr_fb[LED_COUNT][3];
+static uint8_t hdr_err[LED_COUNT][3];       // Resto da quantização (1/256 de nível)
+
+// Os restos começam espalhados para que pixels com o mesmo valor não
+// troquem de nível todos no mesmo envio
+void hdr_init(void)
+{
+    for (uint i = 0; i < LED_COUNT; i++) {
+        for (uint c = 0; c < 3; c++) {
+            hdr_fb[i][c] = 0;
+            hdr_err[i][c] = (i * 157 + c * 85) & 0xFF;
+        }
+    }
+}
+
+void hdr_set(uint index, uint16_t r, uint16_t g, uint16_t b)
+{
+    hdr_fb[index][0] = g;
+    hdr_fb[index][1] = r;
+    hdr_fb[index][2] = b;
+}
+
+void hdr_fill(uint16_t r, uint16_t g, uint16_t b)
+{
+    for (uint i = 0; i < LED_COUNT; i++)
+        hdr_set(i, r, g, b);
+}
+
+// Quantiza o framebuffer para 8 bits e envia aos LEDs
+void hdr_present(void)
+{
+    const uint16_t *fb = &hdr_fb[0][0];
+    uint8_t *err = &hdr_err[0][0];
+
+    for (uint i = 0; i < LED_COUNT * 3; i++) {
+        uint32_t v = fb[i] + err[i];
+        uint32_t out = v >> 8;
+        err[i] = v;                             // Guarda os 8 bits de baixo
+        if (out > 255)
+            out = 255;
+        pio_sm_put_blocking(np_pio, sm, out << 24);
+    }
+
+    // Espera o último byte sair e o tempo de latch dos LEDs
+    while (!pio_sm_is_tx_fifo_empty(np_pio, sm))
+        tight_loop_contents();
+    busy_wait_us_32(HDR_LATCH_US);
+}
+
+// Reenvia o framebuffer continuamente durante ms milissegundos
+void hdr_show(uint32_t ms)
+{
+    absolute_time_t end = make_timeout_time_ms(ms);
+    do {
+        hdr_present();
+    } while (absolute_time_diff_us(get_absolute_time(), end) > 0);
+}
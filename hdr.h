@@ -0,0 +1,21 @@
+#ifndef HDR_H
+#define HDR_H
+
+#include "pico/stdlib.h"
+
+// Framebuffer linear de 16 bits por canal com dithering temporal
+//
+// Os valores (0..65535) são proporcionais à luz emitida. A cada envio para os
+// LEDs, cada canal é quantizado para 8 bits e o resto é somado no envio
+// seguinte; repetindo o envio a centenas de Hz, a média percebida tem os
+// 16 bits de resolução mesmo perto do preto.
+
+#define HDR_LATCH_US 300            // Tempo em nível baixo para os LEDs aceitarem o frame
+
+void hdr_init(void);
+void hdr_set(uint index, uint16_t r, uint16_t g, uint16_t b);
+void hdr_fill(uint16_t r, uint16_t g, uint16_t b);
+void hdr_present(void);
+void hdr_show(uint32_t ms);
+
+#endif
@@ -0,0 +1,73 @@
+#include "neopixel.h"
+#include "ws2818b.pio.h"             // Programa para controle de LEDs WS2812B
+
+npLED_t leds[LED_COUNT];            // Array para armazenar o estado de cada LED
+PIO np_pio;                         // Variável para referenciar a instância PIO usada
+uint sm;                            // Variável para armazenar o número do state machine usado
+
+int getIndex(int x, int y) {
+    // Se a linha for par (0, 2, 4), percorremos da esquerda para a direita.
+    // Se a linha for ímpar (1, 3), percorremos da direita para a esquerda.
+    if (y % 2 == 0) {
+        return (LED_COUNT - 1) - (y * MATRIX_WIDTH + x); // Linha par (esquerda para direita).
+    } else {
+        return (LED_COUNT - 1) - (y * MATRIX_WIDTH + (MATRIX_WIDTH - 1 - x)); // Linha ímpar (direita para esquerda).
+    }
+}
+
+// Função para inicializar o PIO para controle dos LEDs
+void npInit(uint pin)
+{
+    uint offset = pio_add_program(pio0, &ws2818b_program); // Carregar o programa PIO
+    np_pio = pio0;                                         // Usar o primeiro bloco PIO
+
+    sm = pio_claim_unused_sm(np_pio, false);              // Tentar usar uma state machine do pio0
+    if (sm < 0)                                           // Se não houver disponível no pio0
+    {
+        np_pio = pio1;                                    // Mudar para o pio1
+        sm = pio_claim_unused_sm(np_pio, true);           // Usar uma state machine do pio1
+    }
+
+    ws2818b_program_init(np_pio, sm, offset, pin, 800000.f); // Inicializar state machine para LEDs
+
+    for (uint i = 0; i < LED_COUNT; ++i)                  // Inicializar todos os LEDs como apagados
+    {
+        leds[i].R = 0;
+        leds[i].G = 0;
+        leds[i].B = 0;
+    }
+}
+
+// Função para definir a cor de um LED específico
+void npSetLED(const uint index, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+    leds[index].R = r;                                    // Definir componente vermelho
+    leds[index].G = g;                                    // Definir componente verde
+    leds[index].B = b;                                    // Definir componente azul
+}
+
+// Função para limpar (apagar) todos os LEDs
+void npClear()
+{
+    for (uint i = 0; i < LED_COUNT; ++i)                  // Iterar sobre todos os LEDs
+        npSetLED(i, 0, 0, 0);                             // Definir cor como preta (apagado)
+}
+
+// Função para atualizar os LEDs no hardware
+void npWrite()
+{
+    for (uint i = 0; i < LED_COUNT; ++i)                  // Iterar sobre todos os LEDs
+    {
+        pio_sm_put_blocking(np_pio, sm, leds[i].G<<24);       // Enviar componente verde
+        pio_sm_put_blocking(np_pio, sm, leds[i].R<<24);       // Enviar componente vermelho
+        pio_sm_put_blocking(np_pio, sm, leds[i].B<<24);       // Enviar componente azul
+    }
+}
+
+// Envia um frame já no formato GRB e na ordem física dos LEDs, lido de onde
+// estiver (por exemplo, direto da flash), sem passar pelo array leds
+void npWriteRaw(const uint8_t *grb)
+{
+    for (uint i = 0; i < LED_COUNT * 3; ++i)
+        pio_sm_put_blocking(np_pio, sm, (uint32_t)grb[i] << 24);
+}
@@ -0,0 +1,37 @@
+#ifndef NEOPIXEL_H
+#define NEOPIXEL_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"           // Biblioteca para manipulação de periféricos PIO
+
+// Dimensões da matriz (podem ser redefinidas no CMake para painéis maiores)
+#ifndef MATRIX_WIDTH
+#define MATRIX_WIDTH 5
+#endif
+#ifndef MATRIX_HEIGHT
+#define MATRIX_HEIGHT 5
+#endif
+
+#define LED_COUNT (MATRIX_WIDTH * MATRIX_HEIGHT) // Número de LEDs na matriz
+#define LED_PIN 7                   // Pino GPIO conectado aos LEDs
+
+// Estrutura para representar um pixel com componentes RGB
+struct pixel_t {
+    uint32_t G, R, B;                // Componentes de cor: Verde, Vermelho e Azul
+};
+
+typedef struct pixel_t pixel_t;     // Alias para a estrutura pixel_t
+typedef pixel_t npLED_t;            // Alias para facilitar o uso no contexto de LEDs
+
+extern npLED_t leds[LED_COUNT];     // Array para armazenar o estado de cada LED
+extern PIO np_pio;                  // Variável para referenciar a instância PIO usada
+extern uint sm;                     // Variável para armazenar o número do state machine usado
+
+int getIndex(int x, int y);
+void npInit(uint pin);
+void npSetLED(const uint index, const uint8_t r, const uint8_t g, const uint8_t b);
+void npClear();
+void npWrite();
+void npWriteRaw(const uint8_t *grb);
+
+#endif
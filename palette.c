@@ -0,0 +1,88 @@
+#include "palette.h"
+#include "neopixel.h"
+
+// Com 4 bits, dois LEDs por byte: o LED par fica no nibble de baixo
+#define PAL_FB_BYTES ((LED_COUNT * PAL_BITS + 7) / 8)
+
+static uint32_t pal_colors[PAL_SIZE];
+static uint8_t pal_fb[PAL_FB_BYTES];        // Índices na ordem física dos LEDs
+
+void pal_set_color(uint idx, uint32_t color)
+{
+    pal_colors[idx & (PAL_SIZE - 1)] = color;
+}
+
+void pal_load_colors(uint first, const uint32_t *colors, uint count)
+{
+    for (uint i = 0; i < count; i++)
+        pal_set_color(first + i, colors[i]);
+}
+
+uint32_t pal_get_color(uint idx)
+{
+    return pal_colors[idx & (PAL_SIZE - 1)];
+}
+
+// Gira count entradas a partir de first em uma posição: a cor de cada
+// entrada passa para a seguinte e a última volta para a primeira
+void pal_cycle(uint first, uint count)
+{
+    if (count < 2 || first + count > PAL_SIZE)
+        return;
+    uint32_t last = pal_colors[first + count - 1];
+    for (uint i = first + count - 1; i > first; i--)
+        pal_colors[i] = pal_colors[i - 1];
+    pal_colors[first] = last;
+}
+
+void pal_set(uint index, uint idx)
+{
+#if PAL_BITS == 4
+    uint8_t *p = &pal_fb[index >> 1];
+    if (index & 1)
+        *p = (*p & 0x0F) | (idx << 4);
+    else
+        *p = (*p & 0xF0) | (idx & 0x0F);
+#else
+    pal_fb[index] = idx;
+#endif
+}
+
+uint pal_get(uint index)
+{
+#if PAL_BITS == 4
+    return (pal_fb[index >> 1] >> ((index & 1) * 4)) & 0x0F;
+#else
+    return pal_fb[index];
+#endif
+}
+
+void pal_fill(uint idx)
+{
+#if PAL_BITS == 4
+    idx = (idx & 0x0F) * 0x11;
+#endif
+    for (uint i = 0; i < PAL_FB_BYTES; i++)
+        pal_fb[i] = idx;
+}
+
+// Copia uma imagem de índices, um byte por pixel e linha a linha
+// (MATRIX_HEIGHT linhas de MATRIX_WIDTH pixels), para a ordem física dos LEDs
+void pal_blit(const uint8_t *image)
+{
+    for (int y = 0; y < MATRIX_HEIGHT; y++)
+        for (int x = 0; x < MATRIX_WIDTH; x++)
+            pal_set(getIndex(x, y), *image++);
+}
+
+// Expande cada índice para a cor da paleta e envia G, R e B ao PIO. O PIO
+// só transmite os 8 bits de cima de cada palavra, então basta deslocar a cor.
+void pal_present(void)
+{
+    for (uint i = 0; i < LED_COUNT; i++) {
+        uint32_t c = pal_colors[pal_get(i)];
+        pio_sm_put_blocking(np_pio, sm, c << 16);   // Verde
+        pio_sm_put_blocking(np_pio, sm, c << 8);    // Vermelho
+        pio_sm_put_blocking(np_pio, sm, c << 24);   // Azul
+    }
+}
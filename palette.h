@@ -0,0 +1,33 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include "pico/stdlib.h"
+
+// Framebuffer indexado com paleta
+//
+// Cada LED guarda só o índice da sua cor (PAL_BITS bits, 4 ou 8) e a paleta
+// guarda as cores 0x00RRGGBB. A expansão para GRB acontece durante o envio
+// ao PIO. Trocar uma entrada da paleta recolore todos os LEDs que a usam,
+// o que permite animar por ciclo de paleta sem redesenhar o frame.
+
+#ifndef PAL_BITS
+#define PAL_BITS 4                  // 4 (16 cores) ou 8 (256 cores)
+#endif
+
+#if PAL_BITS != 4 && PAL_BITS != 8
+#error "PAL_BITS deve ser 4 ou 8"
+#endif
+
+#define PAL_SIZE (1u << PAL_BITS)   // Número de entradas da paleta
+
+void pal_set_color(uint idx, uint32_t color);
+void pal_load_colors(uint first, const uint32_t *colors, uint count);
+uint32_t pal_get_color(uint idx);
+void pal_cycle(uint first, uint count);
+void pal_set(uint index, uint idx);
+uint pal_get(uint index);
+void pal_fill(uint idx);
+void pal_blit(const uint8_t *image);
+void pal_present(void);
+
+#endif
@@ -0,0 +1,179 @@
+#include "pattern.h"
+
+// Zera os bits além do último LED, que sobram na última palavra
+static inline void pat_trim(pattern_t *p)
+{
+#if LED_COUNT % 32
+    p->w[PAT_WORDS - 1] &= (1u << (LED_COUNT % 32)) - 1;
+#else
+    (void)p;
+#endif
+}
+
+void pat_clear(pattern_t *p)
+{
+    for (uint i = 0; i < PAT_WORDS; i++)
+        p->w[i] = 0;
+}
+
+void pat_set(pattern_t *p, int x, int y)
+{
+    if ((uint32_t)x < MATRIX_WIDTH && (uint32_t)y < MATRIX_HEIGHT) {
+        uint bit = y * MATRIX_WIDTH + x;
+        p->w[bit >> 5] |= 1u << (bit & 31);
+    }
+}
+
+bool pat_get(const pattern_t *p, int x, int y)
+{
+    if ((uint32_t)x >= MATRIX_WIDTH || (uint32_t)y >= MATRIX_HEIGHT)
+        return false;
+    uint bit = y * MATRIX_WIDTH + x;
+    return (p->w[bit >> 5] >> (bit & 31)) & 1;
+}
+
+// Máscara do usuário: uma palavra por linha, com o bit x aceso para a coluna x
+void pat_from_rows(pattern_t *p, const uint32_t *rows)
+{
+    pat_clear(p);
+    for (int y = 0; y < MATRIX_HEIGHT; y++)
+        for (int x = 0; x < MATRIX_WIDTH; x++)
+            if ((rows[y] >> x) & 1)
+                pat_set(p, x, y);
+}
+
+void pat_diagonal(pattern_t *p)
+{
+    pat_clear(p);
+    for (int i = 0; i < MATRIX_WIDTH && i < MATRIX_HEIGHT; i++)
+        pat_set(p, i, i);
+}
+
+void pat_anti_diagonal(pattern_t *p)
+{
+    pat_clear(p);
+    for (int i = 0; i < MATRIX_WIDTH && i < MATRIX_HEIGHT; i++)
+        pat_set(p, MATRIX_WIDTH - 1 - i, i);
+}
+
+// Anel a r pixels da borda (r = 0 é a própria borda)
+void pat_ring(pattern_t *p, int r)
+{
+    int x1 = MATRIX_WIDTH - 1 - r, y1 = MATRIX_HEIGHT - 1 - r;
+    pat_clear(p);
+    for (int x = r; x <= x1; x++) {
+        pat_set(p, x, r);
+        pat_set(p, x, y1);
+    }
+    for (int y = r; y <= y1; y++) {
+        pat_set(p, r, y);
+        pat_set(p, x1, y);
+    }
+}
+
+// Coluna x e linha y inteiras
+void pat_cross(pattern_t *p, int x, int y)
+{
+    pat_clear(p);
+    for (int i = 0; i < MATRIX_WIDTH; i++)
+        pat_set(p, i, y);
+    for (int i = 0; i < MATRIX_HEIGHT; i++)
+        pat_set(p, x, i);
+}
+
+// Tabuleiro de xadrez; phase 1 acende as casas complementares
+void pat_checker(pattern_t *p, int phase)
+{
+    pat_clear(p);
+    for (int y = 0; y < MATRIX_HEIGHT; y++)
+        for (int x = 0; x < MATRIX_WIDTH; x++)
+            if (((x + y + phase) & 1) == 0)
+                pat_set(p, x, y);
+}
+
+void pat_and(pattern_t *dst, const pattern_t *a, const pattern_t *b)
+{
+    for (uint i = 0; i < PAT_WORDS; i++)
+        dst->w[i] = a->w[i] & b->w[i];
+}
+
+void pat_or(pattern_t *dst, const pattern_t *a, const pattern_t *b)
+{
+    for (uint i = 0; i < PAT_WORDS; i++)
+        dst->w[i] = a->w[i] | b->w[i];
+}
+
+void pat_xor(pattern_t *dst, const pattern_t *a, const pattern_t *b)
+{
+    for (uint i = 0; i < PAT_WORDS; i++)
+        dst->w[i] = a->w[i] ^ b->w[i];
+}
+
+void pat_not(pattern_t *dst, const pattern_t *a)
+{
+    for (uint i = 0; i < PAT_WORDS; i++)
+        dst->w[i] = ~a->w[i];
+    pat_trim(dst);
+}
+
+// Desloca n bits na ordem lógica (n > 0 para frente, n < 0 para trás). Com n
+// múltiplo de MATRIX_WIDTH o padrão desce ou sobe linhas inteiras; com outros
+// valores os pixels que saem de uma linha entram na seguinte.
+void pat_shift(pattern_t *dst, const pattern_t *src, int n)
+{
+    uint m = n < 0 ? -n : n;
+    int words = m >> 5;
+    uint bits = m & 31;
+    pattern_t t;
+
+    for (int i = 0; i < PAT_WORDS; i++) {
+        uint32_t v = 0;
+        if (n >= 0) {
+            int j = i - words;
+            if (j >= 0) {
+                v = src->w[j] << bits;
+                if (bits && j > 0)
+                    v |= src->w[j - 1] >> (32 - bits);
+            }
+        } else {
+            int j = i + words;
+            if (j < PAT_WORDS) {
+                v = src->w[j] >> bits;
+                if (bits && j + 1 < PAT_WORDS)
+                    v |= src->w[j + 1] << (32 - bits);
+            }
+        }
+        t.w[i] = v;
+    }
+    pat_trim(&t);
+    *dst = t;
+}
+
+// Desloca dx colunas (dx > 0 para a direita, dx < 0 para a esquerda). Ao
+// contrário de pat_shift, os pixels que saem de uma linha são descartados em
+// vez de entrar na linha vizinha.
+void pat_shift_x(pattern_t *dst, const pattern_t *src, int dx)
+{
+    pattern_t cols;                         // Colunas que continuam dentro da linha
+    pat_clear(&cols);
+    for (int y = 0; y < MATRIX_HEIGHT; y++)
+        for (int x = 0; x < MATRIX_WIDTH; x++)
+            if (x - dx >= 0 && x - dx < MATRIX_WIDTH)
+                pat_set(&cols, x, y);
+    pat_shift(dst, src, dx);
+    pat_and(dst, dst, &cols);
+}
+
+// Acende com a cor 0x00RRGGBB só os pixels do padrão, pulando direto de um
+// bit aceso para o próximo; os demais LEDs não são alterados
+void pat_draw(const pattern_t *p, uint32_t color)
+{
+    for (uint i = 0; i < PAT_WORDS; i++) {
+        uint32_t w = p->w[i];
+        while (w) {
+            uint bit = i * 32 + __builtin_ctz(w);
+            w &= w - 1;                         // Apaga o bit aceso mais baixo
+            npSetLED(getIndex(bit % MATRIX_WIDTH, bit / MATRIX_WIDTH), color >> 16, color >> 8, color);
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include "pico/stdlib.h"
+#include "neopixel.h"
+
+// Padrões geométricos como máscaras de bits
+//
+// Cada pixel é um bit, na ordem lógica linha a linha: o bit y*MATRIX_WIDTH + x
+// é o pixel (x, y). Na matriz 5x5 um padrão cabe em uma única palavra; em
+// painéis maiores são usadas PAT_WORDS palavras. As formas são montadas uma
+// vez e combinadas com AND/OR/XOR/deslocamento, e o desenho percorre só os
+// bits acesos.
+
+#define PAT_WORDS ((LED_COUNT + 31) / 32)
+
+typedef struct {
+    uint32_t w[PAT_WORDS];
+} pattern_t;
+
+void pat_clear(pattern_t *p);
+void pat_set(pattern_t *p, int x, int y);
+bool pat_get(const pattern_t *p, int x, int y);
+void pat_from_rows(pattern_t *p, const uint32_t *rows);
+
+void pat_diagonal(pattern_t *p);
+void pat_anti_diagonal(pattern_t *p);
+void pat_ring(pattern_t *p, int r);
+void pat_cross(pattern_t *p, int x, int y);
+void pat_checker(pattern_t *p, int phase);
+
+void pat_and(pattern_t *dst, const pattern_t *a, const pattern_t *b);
+void pat_or(pattern_t *dst, const pattern_t *a, const pattern_t *b);
+void pat_xor(pattern_t *dst, const pattern_t *a, const pattern_t *b);
+void pat_not(pattern_t *dst, const pattern_t *a);
+void pat_shift(pattern_t *dst, const pattern_t *src, int n);
+void pat_shift_x(pattern_t *dst, const pattern_t *src, int dx);
+
+void pat_draw(const pattern_t *p, uint32_t color);
+
+#endif
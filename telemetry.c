@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <malloc.h>
+#include "telemetry.h"
+
+// Símbolos do linker script do SDK
+extern uint32_t __StackTop, __StackBottom;          // Pilha do núcleo 0 (SCRATCH_Y)
+extern uint32_t __StackOneTop;                      // Fim da SCRATCH_X
+extern uint32_t __scratch_x_end__;                  // Fim do código e dados colocados na SCRATCH_X
+extern uint32_t __scratch_y_end__;                  // Fim do código e dados colocados na SCRATCH_Y
+extern char __bss_end__, __end__, __StackLimit;     // Fim dos dados estáticos e limites do heap
+
+typedef struct {
+    char key;
+    uint32_t peak;                  // Maior uso de pilha (bytes) durante a tecla
+} telem_peak_t;
+
+static telem_peak_t peaks[TELEM_MAX_KEYS];
+static uint peak_count = 0;
+static uint32_t peak_core0 = 0;     // Maior uso desde o boot
+
+// Limites medidos de cada núcleo. A janela do núcleo 0 cobre toda a parte
+// livre da SCRATCH_Y, depois do que o linker colocou lá, e não só a pilha
+// nominal, para que um estouro apareça como uso acima do tamanho nominal. Sem
+// pico_multicore a pilha do núcleo 1 não é alocada, então a janela do núcleo 1
+// é a parte livre da SCRATCH_X, logo abaixo: é lá que cai um estouro maior do
+// núcleo 0.
+static uint32_t *stack_lo(uint core)
+{
+    return core == 0 ? &__scratch_y_end__ : &__scratch_x_end__;
+}
+
+static uint32_t *stack_hi(uint core)
+{
+    return core == 0 ? &__StackTop : &__StackOneTop;
+}
+
+static inline uint32_t *current_sp(void)
+{
+    uint32_t *sp;
+    __asm volatile ("mov %0, sp" : "=r"(sp));
+    return sp;
+}
+
+// Preenche a parte livre da pilha do núcleo 0, deixando uma margem abaixo do sp atual
+static void paint_core0(void)
+{
+    uint32_t *end = current_sp() - 16;
+    for (uint32_t *p = stack_lo(0); p < end; p++)
+        *p = TELEM_PAINT;
+}
+
+void telemetry_init(void)
+{
+    paint_core0();
+    // O núcleo 1 não é usado pelo firmware: toda a parte livre da SCRATCH_X pode ser pintada
+    for (uint32_t *p = stack_lo(1); p < stack_hi(1); p++)
+        *p = TELEM_PAINT;
+}
+
+// Bytes da janela já usados, contando do topo até a última palavra sobrescrita
+uint32_t telemetry_stack_used(uint core)
+{
+    uint32_t *p = stack_lo(core);
+    while (p < stack_hi(core) && *p == TELEM_PAINT)
+        p++;
+    return (uint32_t)((uintptr_t)stack_hi(core) - (uintptr_t)p);
+}
+
+// Chamado antes de cada animação
+void telemetry_begin(void)
+{
+    paint_core0();
+}
+
+// Chamado depois de cada animação: registra o pico da tecla
+void telemetry_end(char key)
+{
+    uint32_t used = telemetry_stack_used(0);
+    if (used > peak_core0)
+        peak_core0 = used;
+
+    for (uint i = 0; i < peak_count; i++) {
+        if (peaks[i].key == key) {
+            if (used > peaks[i].peak)
+                peaks[i].peak = used;
+            return;
+        }
+    }
+    if (peak_count < TELEM_MAX_KEYS) {
+        peaks[peak_count].key = key;
+        peaks[peak_count].peak = used;
+        peak_count++;
+    }
+}
+
+// Relatório enviado pela USB
+void telemetry_report(void)
+{
+    uint32_t used0 = telemetry_stack_used(0);
+    uint32_t nominal0 = (uintptr_t)&__StackTop - (uintptr_t)&__StackBottom;
+    uint32_t window0 = (uintptr_t)stack_hi(0) - (uintptr_t)stack_lo(0);
+    uint32_t size1 = (uintptr_t)stack_hi(1) - (uintptr_t)stack_lo(1);
+
+    if (used0 > peak_core0)
+        peak_core0 = used0;
+
+    printf("pilha núcleo 0: pico %lu de %lu bytes (janela %lu)%s\n", (unsigned long)peak_core0,
+           (unsigned long)nominal0, (unsigned long)window0, peak_core0 > nominal0 ? " ESTOURO" : "");
+    // Como o núcleo 1 não roda, qualquer uso da SCRATCH_X é estouro do núcleo 0
+    printf("SCRATCH_X livre (núcleo 1): %lu de %lu bytes usados\n", (unsigned long)telemetry_stack_used(1),
+           (unsigned long)size1);
+
+    for (uint i = 0; i < peak_count; i++)
+        printf("tecla %c: %lu bytes%s\n", peaks[i].key, (unsigned long)peaks[i].peak,
+               peaks[i].peak > nominal0 ? " ESTOURO" : "");
+
+    struct mallinfo mi = mallinfo();
+    // Disponível: o que o heap ainda não reservou mais os blocos livres dentro da reserva
+    uint32_t heap_span = (uintptr_t)&__StackLimit - (uintptr_t)&__end__;
+    printf("heap: %lu em uso, %lu reservados, %lu disponíveis\n", (unsigned long)mi.uordblks,
+           (unsigned long)mi.arena,
+           (unsigned long)(heap_span - mi.arena + mi.fordblks));
+    printf("estático (.data + .bss): %lu bytes\n", (unsigned long)((uintptr_t)&__bss_end__ - SRAM_BASE));
+}
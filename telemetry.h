@@ -0,0 +1,22 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "pico/stdlib.h"
+
+// Telemetria de RAM e pilha
+//
+// A pilha de cada núcleo é preenchida com um padrão conhecido; a marca
+// d'água (high-water mark) é a parte do padrão que já foi sobrescrita.
+// Antes de cada animação a pilha do núcleo 0 é repintada, o que permite
+// medir o pico de cada tecla separadamente.
+
+#define TELEM_PAINT 0xDEADBEEF      // Padrão de preenchimento da pilha
+#define TELEM_MAX_KEYS 16           // Teclas com pico registrado
+
+void telemetry_init(void);
+void telemetry_begin(void);
+void telemetry_end(char key);
+uint32_t telemetry_stack_used(uint core);
+void telemetry_report(void);
+
+#endif
@@ -0,0 +1,151 @@
+// Teste do armazenamento na flash com quedas de energia
+//
+// Roda no computador, com a flash simulada na RAM com o comportamento de uma
+// NOR: gravar só muda bits de 1 para 0 e apagar volta o setor inteiro para
+// 0xFF. Uma queda de energia é injetada em uma operação sorteada, que fica
+// pela metade, e a região é montada de novo. Registros grandes e um log quase
+// cheio fazem a coleta de lixo rodar o tempo todo, incluindo quedas no meio
+// da cópia de um registro.
+//
+// Compilação, a partir da raiz do projeto:
+//   gcc -std=gnu11 -O1 -Itest/stubs -I. test/store_power_loss.c anim_store.c -Wl,--defsym,__flash_binary_end=0 -o store_power_loss
+//   ./store_power_loss
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include "anim_store.h"
+#include "anim_vm.h"
+
+#define NAMES 24
+#define ITERATIONS 5000
+
+uint8_t test_flash[PICO_FLASH_SIZE_BYTES];
+
+static jmp_buf power_loss;
+static long ops_left = -1;          // Operações até a queda (-1: sem queda)
+static int dirty_writes = 0;        // Gravações sobre páginas não apagadas
+
+// Na operação sorteada só uma parte dos bytes chega à flash
+static size_t flash_op(size_t count)
+{
+    if (ops_left < 0 || ops_left-- > 0)
+        return count;
+    return rand() % count;
+}
+
+void flash_range_program(uint32_t offset, const uint8_t *data, size_t count)
+{
+    size_t n = flash_op(count);
+    for (size_t i = 0; i < n; i++) {
+        if (data[i] != 0xFF && (test_flash[offset + i] & data[i]) != data[i])
+            dirty_writes++;
+        test_flash[offset + i] &= data[i];
+    }
+    if (n < count)
+        longjmp(power_loss, 1);
+}
+
+void flash_range_erase(uint32_t offset, size_t count)
+{
+    size_t n = flash_op(count);
+    memset(test_flash + offset, 0xFF, n);
+    if (n < count)
+        longjmp(power_loss, 1);
+}
+
+void sleep_ms(uint32_t ms) { (void)ms; }
+void npWriteRaw(const uint8_t *grb) { (void)grb; }
+void npClear(void) {}
+void npWrite(void) {}
+vm_result_t vm_verify(const uint32_t *prog, uint32_t len_bytes, uint32_t *err_pc) { (void)prog; (void)len_bytes; *err_pc = 0; return VM_OK; }
+vm_result_t vm_run(const uint32_t *prog, uint buzzer_gpio, bool (*should_stop)(void)) { (void)prog; (void)buzzer_gpio; (void)should_stop; return VM_OK; }
+
+// Cada versão tem tamanho e conteúdo derivados do seu número
+static uint32_t version_length(uint32_t v)
+{
+    return v % 2 == 0 ? 16000 + v * 53 % 16000 : 1 + v * 37 % 3000;
+}
+
+static bool matches(int k, uint32_t v)
+{
+    char name[STORE_NAME_LEN];
+    snprintf(name, sizeof(name), "anim%d", k);
+    const store_hdr_t *h = store_find(name);
+    if (v == 0)
+        return h == NULL;
+    if (!h || h->length != version_length(v))
+        return false;
+    const uint8_t *d = store_data(h);
+    for (uint32_t i = 0; i < h->length; i++)
+        if (d[i] != (uint8_t)(v * 131 + i))
+            return false;
+    return true;
+}
+
+int main(void)
+{
+    static uint8_t buf[32 * 1024];
+    uint32_t expected[NAMES] = {0};     // Versão esperada de cada nome (0: ausente)
+    int failures = 0, crashes = 0, full = 0;
+
+    memset(test_flash, 0xFF, sizeof(test_flash));
+    store_mount();
+    srand(1);
+
+    for (uint32_t it = 1; it <= ITERATIONS && failures == 0; it++) {
+        int k = rand() % NAMES;
+        char name[STORE_NAME_LEN];
+        snprintf(name, sizeof(name), "anim%d", k);
+        bool remove = rand() % 10 == 0;
+        uint32_t len = version_length(it);
+        ops_left = rand() % 4 == 0 ? rand() % 200 : -1;
+
+        if (setjmp(power_loss)) {
+            // Depois da queda o nome da operação pode ter a versão antiga ou a nova
+            ops_left = -1;
+            crashes++;
+            store_mount();
+            if (matches(k, remove ? 0 : it))
+                expected[k] = remove ? 0 : it;
+        } else if (remove) {
+            store_delete(name);
+            expected[k] = 0;
+        } else {
+            for (uint32_t i = 0; i < len; i++)
+                buf[i] = (uint8_t)(it * 131 + i);
+            store_result_t res = store_begin(name, STORE_KIND_FRAMES, 10, len);
+            if (res == STORE_OK) {
+                store_append(buf, len);
+                if (rand() % 30 == 0) {
+                    store_abort();
+                } else {
+                    store_commit();
+                    expected[k] = it;
+                }
+            } else if (res == STORE_ERR_FULL) {
+                full++;
+            }
+        }
+        ops_left = -1;
+        if (rand() % 10 == 0)
+            store_mount();
+
+        for (int j = 0; j < NAMES; j++) {
+            if (!matches(j, expected[j])) {
+                printf("iteração %lu: anim%d diferente da versão %lu\n", (unsigned long)it, j,
+                       (unsigned long)expected[j]);
+                failures++;
+            }
+        }
+        if (dirty_writes) {
+            printf("iteração %lu: gravação sobre página não apagada\n", (unsigned long)it);
+            failures++;
+        }
+    }
+
+    printf("%s: %d quedas de energia, %d gravações recusadas por falta de espaço\n",
+           failures ? "FALHOU" : "OK", crashes, full);
+    return failures != 0;
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_STUB_PIO_H
+#define TEST_STUB_PIO_H
+
+#include "pico/stdlib.h"
+
+typedef struct pio_hw *PIO;
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef TEST_STUB_SYNC_H
+#define TEST_STUB_SYNC_H
+
+#include "pico/stdlib.h"
+
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void)status; }
+
+#endif
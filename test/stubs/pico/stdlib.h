@@ -0,0 +1,17 @@
+// Substituto mínimo do SDK para compilar os testes no computador
+#ifndef TEST_STUB_STDLIB_H
+#define TEST_STUB_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+extern uint8_t test_flash[];
+#define XIP_BASE ((uintptr_t)test_flash)
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+
+void sleep_ms(uint32_t ms);
+
+#endif